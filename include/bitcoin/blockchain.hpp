@@ -26,17 +26,26 @@
 #include <bitcoin/blockchain/interface/block_chain.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
+#include <bitcoin/blockchain/pools/admission_queue.hpp>
 #include <bitcoin/blockchain/pools/block_entry.hpp>
 #include <bitcoin/blockchain/pools/block_organizer.hpp>
 #include <bitcoin/blockchain/pools/block_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/latency_histogram.hpp>
+#include <bitcoin/blockchain/pools/parked_blocks.hpp>
+#include <bitcoin/blockchain/pools/pooled_transactions.hpp>
+#include <bitcoin/blockchain/pools/reject_filter.hpp>
 #include <bitcoin/blockchain/pools/transaction_entry.hpp>
 #include <bitcoin/blockchain/pools/transaction_organizer.hpp>
 #include <bitcoin/blockchain/pools/transaction_pool.hpp>
+#include <bitcoin/blockchain/populate/duplicate_filter.hpp>
+#include <bitcoin/blockchain/populate/input_work_list.hpp>
 #include <bitcoin/blockchain/populate/populate_base.hpp>
 #include <bitcoin/blockchain/populate/populate_block.hpp>
 #include <bitcoin/blockchain/populate/populate_chain_state.hpp>
 #include <bitcoin/blockchain/populate/populate_transaction.hpp>
+#include <bitcoin/blockchain/populate/undo_cache.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 #include <bitcoin/blockchain/validate/validate_block.hpp>
 #include <bitcoin/blockchain/validate/validate_input.hpp>
 #include <bitcoin/blockchain/validate/validate_transaction.hpp>
@@ -30,9 +30,13 @@
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
 #include <bitcoin/blockchain/pools/block_organizer.hpp>
+#include <bitcoin/blockchain/pools/pooled_transactions.hpp>
 #include <bitcoin/blockchain/pools/transaction_organizer.hpp>
+#include <bitcoin/blockchain/populate/duplicate_filter.hpp>
 #include <bitcoin/blockchain/populate/populate_chain_state.hpp>
+#include <bitcoin/blockchain/populate/undo_cache.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 
 #if WITH_BLOCKCHAIN_REQUESTER
 #include <bitcoin/protocol/requester.hpp>
@@ -118,6 +122,11 @@ public:
     bool get_transaction_position(size_t& out_height, size_t& out_position,
         const hash_digest& hash, bool require_confirmed) const override;
 
+    /// Get the forks of a tx pooled since startup, from memory (the store
+    /// confirms an entry indexed before the last block disconnection).
+    bool get_pooled_forks(uint32_t& out_forks,
+        const hash_digest& hash) const override;
+
     /////// Get the transaction of the given hash and its block height.
     ////transaction_ptr get_transaction(size_t& out_block_height,
     ////    const hash_digest& hash, bool require_confirmed) const;
@@ -155,6 +164,9 @@ public:
     /// Get full chain state relative to the branch top.
     chain::chain_state::ptr chain_state(branch::const_ptr branch) const override;
 
+    /// Odd while a reorganization is in progress.
+    size_t reorganization_sequence() const override;
+
     // ========================================================================
     // SAFE CHAIN
     // ========================================================================
@@ -349,12 +361,33 @@ public:
     /// Store a transaction to the pool if valid.
     void organize(transaction_const_ptr tx, result_handler handler) override;
 
+    /// Store a batch of transactions to the pool, each if valid.
+    /// Codes are returned in the order of the given transactions.
+    void organize(transaction_const_ptr_list txs,
+        transaction_organizer::batch_handler handler);
+
     // Properties.
     //-------------------------------------------------------------------------
 
     /// True if the blockchain is stale based on configured age limit.
     bool is_stale() const override;
 
+    /// Depth and wait times of transaction script validation admission.
+    transaction_organizer::admission_statistics admission_stats() const;
+
+    /// Latency histogram of a transaction organization stage.
+    latency_histogram::summary transaction_latency(
+        transaction_organizer::stage step) const;
+
+    /// Statistics of the most recently validated block.
+    validate_block::statistics block_validation_statistics() const;
+
+    /// Hashes of the blocks awaiting organization, in order.
+    hash_list queued_blocks() const;
+
+    /// Remove a block awaiting organization, false if not queued.
+    bool cancel_block(const hash_digest& hash);
+
     /// Get a reference to the blockchain configuration settings.
     const settings& chain_settings() const;
 
@@ -412,8 +445,16 @@ private:
         result_handler handler) const;
     void handle_block(const code& ec, block_const_ptr block,
         result_handler handler) const;
-    void handle_reorganize(const code& ec, block_const_ptr top,
+    void handle_reorganize(const code& ec,
+        block_const_ptr_list_const_ptr incoming_blocks,
+        block_const_ptr_list_const_ptr outgoing_blocks, size_t fork_height,
         result_handler handler);
+    bool handle_reorganized(code ec, size_t fork_height,
+        block_const_ptr_list_const_ptr incoming,
+        block_const_ptr_list_const_ptr outgoing);
+    void handle_repooled(const code& ec,
+        block_const_ptr_list_const_ptr outgoing);
+    void load_duplicate_filter();
 
     // These are thread safe.
     std::atomic<bool> stopped_;
@@ -421,6 +462,7 @@ private:
     const time_t notify_limit_seconds_;
     bc::atomic<block_const_ptr> last_block_;
     bc::atomic<transaction_const_ptr> last_transaction_;
+    std::atomic<size_t> reorganization_sequence_;
     const populate_chain_state chain_state_populator_;
     database::data_base database_;
 
@@ -432,6 +474,20 @@ private:
     mutable prioritized_mutex validation_mutex_;
     mutable threadpool priority_pool_;
     mutable dispatcher dispatch_;
+    script_cache script_cache_;
+    pooled_transactions pooled_transactions_;
+    duplicate_filter duplicate_filter_;
+
+    // This is protected by validation_mutex_.
+    // The lowest fork point reorganized while the filter was loading.
+    size_t duplicate_fork_height_;
+
+    // The duplicate filter loads on its own thread, joined on close.
+    threadpool loader_pool_;
+    dispatcher loader_dispatch_;
+
+    // These are thread safe.
+    undo_cache undo_cache_;
     transaction_organizer transaction_organizer_;
     block_organizer block_organizer_;
 
@@ -92,6 +92,11 @@ public:
         size_t& out_position, const hash_digest& hash,
         bool require_confirmed) const = 0;
 
+    /// Get the forks of a tx pooled since startup, from memory (the store
+    /// confirms an entry indexed before the last block disconnection).
+    virtual bool get_pooled_forks(uint32_t& out_forks,
+        const hash_digest& hash) const = 0;
+
     /////// Get the transaction of the given hash and its block height.
     ////virtual transaction_ptr get_transaction(size_t& out_block_height,
     ////    const hash_digest& hash, bool require_confirmed) const = 0;
@@ -127,6 +132,10 @@ public:
     /// Get a reference to the chain state relative to the next block.
     virtual chain::chain_state::ptr chain_state(
         branch::const_ptr branch) const = 0;
+
+    /// Incremented at the start and end of each reorganization, so odd while
+    /// one is in progress. Equal even values bracket consistent store reads.
+    virtual size_t reorganization_sequence() const = 0;
 };
 
 } // namespace blockchain
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_ADMISSION_QUEUE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_ADMISSION_QUEUE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Bounds the number of concurrent holders of a resource and orders waiters
+/// by priority. When the queue is full the lowest priority waiter is shed.
+class BCB_API admission_queue
+{
+public:
+    typedef std::chrono::microseconds duration;
+
+    struct statistics
+    {
+        size_t depth;
+        size_t active;
+        size_t admitted;
+        size_t shed;
+        duration average_wait;
+        duration maximum_wait;
+    };
+
+    admission_queue(size_t capacity, size_t concurrency);
+
+    /// Block until admitted (success), shed (oversubscribed) or stopped.
+    code enter(uint64_t priority);
+
+    /// Release the slot acquired by a successful enter.
+    void leave();
+
+    /// Release all waiters with service_stopped and refuse new entries.
+    void stop();
+
+    /// A snapshot of queue depth and wait times.
+    statistics stats() const;
+
+private:
+    struct ticket
+    {
+        uint64_t priority;
+        uint64_t sequence;
+        bool shed;
+    };
+
+    // Higher priority first, then first come first served.
+    struct higher
+    {
+        bool operator()(const ticket* left, const ticket* right) const
+        {
+            return left->priority != right->priority ?
+                left->priority > right->priority :
+                left->sequence < right->sequence;
+        }
+    };
+
+    typedef std::set<ticket*, higher> queue;
+
+    bool admissible(const ticket& self) const;
+
+    // These are thread safe.
+    const size_t capacity_;
+    const size_t concurrency_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    size_t active_;
+    size_t admitted_;
+    size_t shed_;
+    uint64_t sequence_;
+    duration total_wait_;
+    duration maximum_wait_;
+    queue pending_;
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -21,15 +21,20 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
 #include <bitcoin/blockchain/pools/block_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/parked_blocks.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 #include <bitcoin/blockchain/validate/validate_block.hpp>
 
 namespace libbitcoin {
@@ -48,12 +53,15 @@ public:
 
     /// Construct an instance.
     block_organizer(prioritized_mutex& mutex, dispatcher& dispatch,
-        threadpool& thread_pool, fast_chain& chain, const settings& settings,
-        bool relay_transactions);
+        threadpool& thread_pool, fast_chain& chain, const script_cache& cache,
+        const settings& settings, bool relay_transactions);
 
     bool start();
     bool stop();
 
+    /// Queue the block for organization in order of arrival. This returns
+    /// immediately, the handler is invoked from an organizer thread. If the
+    /// queue is full the handler is invoked with oversubscribed.
     void organize(block_const_ptr block, result_handler handler);
     void subscribe(reorganize_handler&& handler);
     void unsubscribe();
@@ -61,24 +69,69 @@ public:
     /// Remove all message vectors that match block hashes.
     void filter(get_data_ptr message) const;
 
+    /// Remove all message vectors that match block hashes in the pool or
+    /// the predicate (such as a store query).
+    void filter(get_data_ptr message,
+        const block_pool::hash_predicate& exists) const;
+
+    /// Statistics of the most recently validated block.
+    validate_block::statistics validation_statistics() const;
+
+    /// Hashes of the blocks awaiting organization, in order.
+    hash_list queued() const;
+
+    /// Remove the block from the queue, invoking its handler with
+    /// operation_failed. False if not queued (including if organizing).
+    bool cancel(const hash_digest& hash);
+
 protected:
     bool stopped() const;
 
 private:
+    struct queued_block
+    {
+        block_const_ptr block;
+        result_handler handler;
+    };
+
+    typedef std::deque<queued_block> block_queue;
+
     // Utility.
     bool set_branch_height(branch::ptr branch);
+    static void signal(const code& ec, std::promise<code>& promise);
+
+    // Organize sequence.
+    void do_simulate();
+    void enqueue(block_const_ptr block, result_handler handler);
+    void drain();
+    void organize(const queued_block& queued);
+
+    // Simulate sequence.
+    bool simulate(block_const_ptr block, code& out_ec);
+    code simulate(branch::ptr branch);
+
+    // Parked sub-sequence.
+    bool get_sufficient_work(bool& out_sufficient, branch::const_ptr branch);
+    code park(branch::const_ptr branch);
 
     // Verify sub-sequence.
     void handle_check(const code& ec, block_const_ptr block,
+        validate_block::duration checked, result_handler handler);
+    void verify(branch::ptr branch, size_t index, bool sufficient,
+        validate_block::duration checked, result_handler handler);
+    void handle_parked_accept(const code& ec, branch::ptr parked,
+        branch::ptr branch, size_t index, bool sufficient,
+        validate_block::duration checked, result_handler handler);
+    void handle_parked_connect(const code& ec, branch::ptr parked,
+        branch::ptr branch, size_t index, bool sufficient,
+        validate_block::duration checked, result_handler handler);
+    void handle_accept(const code& ec, branch::ptr branch, bool sufficient,
         result_handler handler);
-    void handle_accept(const code& ec, branch::ptr branch,
-        result_handler handler);
-    void handle_connect(const code& ec, branch::ptr branch,
+    void handle_connect(const code& ec, branch::ptr branch, bool sufficient,
         result_handler handler);
     void organized(branch::ptr branch, result_handler handler);
     void handle_reorganized(const code& ec, branch::const_ptr branch,
         block_const_ptr_list_ptr outgoing, result_handler handler);
-    void signal_completion(const code& ec);
 
     // Subscription.
     void notify(size_t branch_height, block_const_ptr_list_const_ptr branch,
@@ -87,14 +140,42 @@ private:
     // This must be protected by the implementation.
     fast_chain& fast_chain_;
 
+    // This is protected by the organizer mutex (critical section).
+    // Pooled blocks whose bodies are not yet validated, or failed validation.
+    parked_blocks parked_;
+
     // These are thread safe.
     prioritized_mutex& mutex_;
     std::atomic<bool> stopped_;
-    std::promise<code> resume_;
+    const size_t queue_capacity_;
+
     dispatcher& dispatch_;
     block_pool block_pool_;
     validate_block validator_;
+
+    // This is protected by simulate_mutex_.
+    // Simulations share the priority pool but not the critical section,
+    // stop awaits the simulation in progress by taking the mutex.
+    validate_block simulator_;
+    std::mutex simulate_mutex_;
+
     reorganize_subscriber::ptr subscriber_;
+
+    // These are protected by queue_mutex_.
+    // Blocks await the critical section in order of arrival, one drain runs.
+    // Simulations await the simulate thread, failed on stop if not started.
+    // Each is bounded by the queue capacity, as each holds full blocks.
+    block_queue queue_;
+    block_queue simulations_;
+    bool draining_;
+    mutable std::mutex queue_mutex_;
+
+    // Only organizer threads block, these are joined first on destruct.
+    // Simulations have their own thread so that they cannot delay the drain.
+    threadpool organizer_pool_;
+    threadpool simulate_pool_;
+    dispatcher organize_dispatch_;
+    dispatcher simulate_dispatch_;
 };
 
 } // namespace blockchain
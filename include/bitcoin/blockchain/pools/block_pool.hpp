@@ -20,6 +20,7 @@
 #define LIBBITCOIN_BLOCKCHAIN_BLOCK_POOL_HPP
 
 #include <cstddef>
+#include <functional>
 #include <boost/bimap.hpp>
 #include <boost/bimap/multiset_of.hpp>
 #include <boost/bimap/unordered_set_of.hpp>
@@ -34,16 +35,20 @@ namespace blockchain {
 /// This class is thread safe against concurrent filtering only.
 /// There is no search within blocks of the block pool (just hashes).
 /// The branch object contains chain query for new (leaf) block validation.
-/// All pool blocks are valid, lacking only sufficient work for reorganzation.
+/// All pool blocks are valid, lacking only sufficient work for reorganzation,
+/// or are header-valid blocks parked by the organizer until their branch has
+/// sufficient work.
 class BCB_API block_pool
 {
 public:
+    typedef std::function<bool(const hash_digest&)> hash_predicate;
+
     block_pool(size_t maximum_depth);
 
     // The number of blocks in the pool.
     size_t size() const;
 
-    /// Add newly-validated block (work insufficient to reorganize).
+    /// Add newly-validated or parked block (work insufficient to reorganize).
     void add(block_const_ptr valid_block);
 
     /// Add root path of reorganized blocks (no branches).
@@ -58,6 +63,10 @@ public:
     /// Remove all message vectors that match block hashes.
     void filter(get_data_ptr message) const;
 
+    /// Remove all message vectors that match block hashes in the pool or
+    /// the predicate (such as a store query), in one pass preserving order.
+    void filter(get_data_ptr message, const hash_predicate& exists) const;
+
     /// Get the root path to and including the new block.
     /// This will be empty if the block already exists in the pool.
     branch::ptr get_path(block_const_ptr candidate_block) const;
@@ -69,7 +78,6 @@ protected:
         boost::bimaps::unordered_set_of<block_entry>,
         boost::bimaps::multiset_of<size_t>> block_entries;
 
-    void prune(const hash_list& hashes, size_t minimum_height);
     bool exists(block_const_ptr candidate_block) const;
     block_const_ptr parent(block_const_ptr block) const;
     ////void log_content() const;
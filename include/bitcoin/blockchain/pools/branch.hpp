@@ -22,6 +22,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
@@ -29,7 +32,8 @@
 namespace libbitcoin {
 namespace blockchain {
 
-/// This class is not thread safe.
+/// This class is not thread safe, except that populate_spent and
+/// populate_prevout may be called concurrently once the branch is complete.
 class BCB_API branch
 {
 public:
@@ -99,10 +103,31 @@ protected:
     uint32_t median_time_past_at(size_t index) const;
 
 private:
+    struct position
+    {
+        size_t block;
+        size_t transaction;
+    };
+
+    typedef std::unordered_map<hash_digest, position> transaction_index;
+    typedef std::unordered_set<chain::point> spend_index;
+
+    // Indexes are built on first lookup, the branch must not change after.
+    void index_transactions() const;
+    void index_spends() const;
+
     size_t height_;
 
     /// The chain of blocks in the branch.
     block_const_ptr_list_ptr blocks_;
+
+    /// Tx hash to position of its last occurrence in the branch.
+    mutable std::once_flag transactions_indexed_;
+    mutable transaction_index transactions_;
+
+    /// Outpoints spent by the branch, excluding the top block.
+    mutable std::once_flag spends_indexed_;
+    mutable spend_index spends_;
 };
 
 } // namespace blockchain
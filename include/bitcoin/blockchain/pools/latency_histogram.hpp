@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_LATENCY_HISTOGRAM_HPP
+#define LIBBITCOIN_BLOCKCHAIN_LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Counts durations into power of two microsecond buckets.
+class BCB_API latency_histogram
+{
+public:
+    typedef std::chrono::microseconds duration;
+
+    /// Bucket zero counts zero durations, bucket n counts [2^(n-1), 2^n).
+    /// The last bucket also counts all longer durations.
+    static const size_t bucket_count = 32;
+
+    struct summary
+    {
+        size_t count;
+        duration total;
+        duration maximum;
+        std::array<size_t, bucket_count> buckets;
+    };
+
+    latency_histogram();
+
+    void record(duration elapsed);
+    summary summarize() const;
+
+    static size_t bucket(duration elapsed);
+
+private:
+    std::array<std::atomic<size_t>, bucket_count> buckets_;
+    std::atomic<size_t> count_;
+    std::atomic<uint64_t> total_;
+    std::atomic<uint64_t> maximum_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
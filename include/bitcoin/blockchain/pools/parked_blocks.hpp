@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_PARKED_BLOCKS_HPP
+#define LIBBITCOIN_BLOCKCHAIN_PARKED_BLOCKS_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/pools/branch.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is not thread safe.
+/// Pooled blocks that have passed only header checks, because their branch
+/// lacked the work to reorganize, and the consensus failure of any such block
+/// whose body has since failed validation.
+class BCB_API parked_blocks
+{
+public:
+    parked_blocks(size_t maximum_depth);
+
+    /// The number of parked blocks.
+    size_t size() const;
+
+    /// Park the header-valid block at the given height.
+    void park(const hash_digest& hash, size_t height);
+
+    /// True if the block is parked (including if failed).
+    bool is_parked(const hash_digest& hash) const;
+
+    /// Record the validation failure of a parked block if it is retained,
+    /// otherwise the block remains parked for later validation.
+    void fail(const hash_digest& hash, const code& ec);
+
+    /// Remove the parked block (its body is valid).
+    void unpark(const hash_digest& hash);
+
+    /// Remove parked blocks that have been pruned from the block pool.
+    void prune(size_t top_height);
+
+    /// The retained failure of any pooled (non-top) block of the branch.
+    code get_error(branch::const_ptr branch) const;
+
+    /// The branch through the block at the given index, same fork point.
+    static branch::ptr get_prefix(branch::const_ptr branch, size_t index);
+
+    /// True if the failure is a property of the block (consensus), not of
+    /// the node (store failure or stop).
+    static bool is_retained(const code& ec);
+
+private:
+    struct parked_block
+    {
+        size_t height;
+        code error;
+    };
+
+    typedef std::unordered_map<hash_digest, parked_block> parked_map;
+
+    const size_t maximum_depth_;
+    parked_map parked_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
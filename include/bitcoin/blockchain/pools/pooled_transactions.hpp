@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_POOLED_TRANSACTIONS_HPP
+#define LIBBITCOIN_BLOCKCHAIN_POOLED_TRANSACTIONS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// An in-memory index of the unconfirmed transactions stored since startup,
+/// mapping each tx hash to the fork flags under which it was validated.
+/// A miss is not authoritative, the store may hold older unconfirmed txs.
+/// A hit is exact only while fresh, as confirmation removes its entry, but a
+/// disconnection changes the store unobserved and so stales every entry.
+/// Each shard evicts its oldest entries once full.
+class BCB_API pooled_transactions
+{
+public:
+    /// A zero capacity disables the index.
+    pooled_transactions(size_t capacity);
+
+    /// Get the forks under which the tx was pooled, false if not indexed.
+    /// A stale hit is a hint to be confirmed by the store.
+    bool find(uint32_t& out_forks, bool& out_fresh,
+        const hash_digest& hash) const;
+
+    /// Index a pooled tx (refreshing an existing entry), evicting the oldest
+    /// entry of a full shard.
+    void add(const hash_digest& hash, uint32_t forks);
+
+    /// Remove a tx, such as upon its confirmation.
+    void remove(const hash_digest& hash);
+
+    /// Stale all entries, such as upon disconnection of a block.
+    void invalidate();
+
+    /// The number of indexed txs.
+    size_t size() const;
+
+private:
+    struct entry
+    {
+        uint32_t forks;
+        uint64_t sequence;
+        uint64_t epoch;
+    };
+
+    typedef std::unordered_map<hash_digest, entry> entries;
+
+    // Insertion order, entries removed or refreshed since are skipped.
+    typedef std::deque<std::pair<hash_digest, uint64_t>> order;
+
+    struct shard
+    {
+        entries map;
+        order fifo;
+        uint64_t sequence = 0;
+        mutable shared_mutex mutex;
+    };
+
+    static const size_t shard_count = 16;
+
+    shard& select(const hash_digest& hash) const;
+    void evict(shard& bucket);
+    void compact(shard& bucket);
+
+    // These are thread safe.
+    const size_t shard_capacity_;
+    std::atomic<uint64_t> epoch_;
+
+    // These are protected by the shard mutex.
+    mutable std::array<shard, shard_count> shards_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_REJECT_FILTER_HPP
+#define LIBBITCOIN_BLOCKCHAIN_REJECT_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// A fixed size table of recently rejected transaction hashes and the reason
+/// for rejection. Newer entries overwrite older entries in the same slot.
+class BCB_API reject_filter
+{
+public:
+    /// A zero capacity disables the filter.
+    reject_filter(size_t capacity);
+
+    /// The reason the transaction was recently rejected, or success.
+    code find(const hash_digest& hash) const;
+
+    /// Record the rejection if the reason does not depend on pool state.
+    void store(const hash_digest& hash, const code& reason);
+
+    /// Drop all rejections (call on each new chain tip).
+    void clear();
+
+    /// True if the rejection will be repeated for the same transaction.
+    static bool is_cacheable(const code& reason);
+
+private:
+    struct entry
+    {
+        uint64_t key;
+        error::error_code_t reason;
+    };
+
+    uint64_t key(const hash_digest& hash) const;
+
+    // These are thread safe.
+    const uint64_t salt_;
+
+    // These are protected by mutex.
+    std::vector<entry> entries_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
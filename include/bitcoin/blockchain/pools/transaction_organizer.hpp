@@ -19,17 +19,25 @@
 #ifndef LIBBITCOIN_BLOCKCHAIN_TRANSACTION_ORGANIZER_HPP
 #define LIBBITCOIN_BLOCKCHAIN_TRANSACTION_ORGANIZER_HPP
 
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <future>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
+#include <bitcoin/blockchain/pools/admission_queue.hpp>
+#include <bitcoin/blockchain/pools/latency_histogram.hpp>
+#include <bitcoin/blockchain/pools/reject_filter.hpp>
 #include <bitcoin/blockchain/pools/transaction_pool.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 #include <bitcoin/blockchain/validate/validate_transaction.hpp>
 
 namespace libbitcoin {
@@ -46,17 +54,57 @@ public:
     typedef safe_chain::inventory_fetch_handler inventory_fetch_handler;
     typedef safe_chain::merkle_block_fetch_handler merkle_block_fetch_handler;
     typedef resubscriber<code, transaction_const_ptr> transaction_subscriber;
+    typedef std::vector<code> code_list;
+    typedef std::function<void(const code&, const code_list&)> batch_handler;
+    typedef admission_queue::statistics admission_statistics;
+
+    /// Timed stages of transaction organization.
+    enum class stage : size_t
+    {
+        check,
+        populate,
+        accept,
+        admission,
+        connect,
+        lock_wait,
+        push,
+        notify
+    };
+
+    static const size_t stage_count = 8;
+
+    /// The admission priority of a populated tx, its fee rate in satoshis
+    /// per kilobyte.
+    static uint64_t admission_priority(transaction_const_ptr tx);
 
     /// Construct an instance.
     transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch,
-        threadpool& thread_pool, fast_chain& chain, const settings& settings);
+        threadpool& thread_pool, fast_chain& chain, script_cache& cache,
+        const settings& settings);
 
     bool start();
     bool stop();
 
     void organize(transaction_const_ptr tx, result_handler handler);
+
+    /// Organize a batch, resolving dependencies between its transactions.
+    void organize(transaction_const_ptr_list txs, batch_handler handler);
+
+    /// Revalidate and repool the transactions of blocks reorganized out.
+    void repool(block_const_ptr_list_const_ptr outgoing,
+        result_handler handler);
+
     void transaction_validate(transaction_const_ptr tx, result_handler handler) const;
 
+    /// Forget recently rejected transactions (call on each new tip).
+    void reset_rejects();
+
+    /// Depth and wait times of the validation admission queue.
+    admission_statistics admission_stats() const;
+
+    /// Histogram of time spent in the given stage.
+    latency_histogram::summary latency(stage step) const;
+
     void subscribe(transaction_handler&& handler);
     void unsubscribe();
 
@@ -68,16 +116,49 @@ protected:
     uint64_t price(transaction_const_ptr tx) const;
 
 private:
+    typedef std::vector<size_t> index_list;
+    typedef std::vector<index_list> index_levels;
+
+    // Batch organize sequence.
+    void organize(transaction_const_ptr_list txs, bool repool,
+        batch_handler handler);
+    code_list check_batch(const transaction_const_ptr_list& txs) const;
+    void check_transactions(const transaction_const_ptr_list& txs,
+        size_t bucket, size_t buckets, code_list& results,
+        result_handler handler) const;
+    void accept_level(const transaction_const_ptr_list& txs,
+        const index_list& level, bool repool, code_list& results) const;
+    code push_transaction(transaction_const_ptr tx);
+    static index_levels sort_dependencies(
+        const transaction_const_ptr_list& txs);
+
+    // Repool sequence.
+    void do_repool(block_const_ptr_list_const_ptr outgoing,
+        result_handler handler);
+    static transaction_const_ptr_list to_transactions(
+        block_const_ptr_list_const_ptr blocks);
+
+    // Organize sequence.
+    code check(transaction_const_ptr tx) const;
+    code accept(transaction_const_ptr tx) const;
+    code connect(transaction_const_ptr tx) const;
+    code check_policy(transaction_const_ptr tx) const;
+    asio::time_point record(stage step, asio::time_point start) const;
+
+    // Commit sequence.
+    code commit(transaction_const_ptr tx);
+    code revalidate(transaction_const_ptr tx) const;
+    void refresh_commit_state();
+    bool is_conflicted(transaction_const_ptr tx) const;
+    bool is_pooled(const hash_digest& hash) const;
+
     // Verify sub-sequence.
-    void handle_check(code const& ec, transaction_const_ptr tx, result_handler handler);
-    void handle_accept(code const& ec, transaction_const_ptr tx, result_handler handler);
-    void handle_connect(code const& ec, transaction_const_ptr tx, result_handler handler);
-    void handle_pushed(code const& ec, transaction_const_ptr tx, result_handler handler);
-    void signal_completion(code const& ec);
+    void handle_validated(code const& ec, transaction_const_ptr tx, result_handler handler) const;
+    static hash_digest reject_key(transaction_const_ptr tx);
 
-    void validate_handle_check(code const& ec, transaction_const_ptr tx, result_handler handler) const;
-    void validate_handle_accept(code const& ec, transaction_const_ptr tx, result_handler handler) const;
-    void validate_handle_connect(code const& ec, transaction_const_ptr tx, result_handler handler) const;
+    void validate_handle_check(code const& ec, transaction_const_ptr tx, bool repool, result_handler handler) const;
+    void validate_handle_accept(code const& ec, transaction_const_ptr tx, asio::time_point start, result_handler handler) const;
+    void validate_handle_connect(code const& ec, transaction_const_ptr tx, asio::time_point start, result_handler handler) const;
 
     // Subscription.
     void notify(transaction_const_ptr tx);
@@ -88,12 +169,23 @@ private:
     // These are thread safe.
     prioritized_mutex& mutex_;
     std::atomic<bool> stopped_;
-    std::promise<code> resume_;
     const settings& settings_;
     dispatcher& dispatch_;
+    dispatcher network_dispatch_;
     transaction_pool transaction_pool_;
     validate_transaction validator_;
+    mutable reject_filter rejects_;
+    admission_queue admission_;
+    mutable std::array<latency_histogram, stage_count> latencies_;
     transaction_subscriber::ptr subscriber_;
+
+    // Held shared by each validation in flight, unique by stop.
+    shared_mutex pipeline_mutex_;
+
+    // These are protected by mutex_.
+    chain::chain_state::ptr commit_state_;
+    // Each spend of a committed tx, to the hash of its spender.
+    std::unordered_map<chain::point, hash_digest> committed_spends_;
 };
 
 } // namespace blockchain
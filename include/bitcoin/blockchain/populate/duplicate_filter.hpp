@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_DUPLICATE_FILTER_HPP
+#define LIBBITCOIN_BLOCKCHAIN_DUPLICATE_FILTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe, except for allocate and load (call before arm).
+/// A blocked counting bloom filter of the hashes of all confirmed transactions
+/// in the store, placed in front of the BIP30 duplicate query. Each hash
+/// counts in eight 4-bit counters within one cache line. Connection counts a
+/// hash up and disconnection counts it down, a saturated counter is never
+/// counted down (which only adds false positives). Until armed, after it has
+/// been loaded from the store, the filter answers every query maybe.
+class BCB_API duplicate_filter
+{
+public:
+    /// The headroom is the count of transactions that may be confirmed after
+    /// allocation at under two percent false positives. Zero disables.
+    duplicate_filter(size_t headroom);
+
+    /// True unless disabled.
+    bool enabled() const;
+
+    /// Size the filter for the stored count plus headroom, if enabled.
+    void allocate(size_t stored);
+
+    /// Count a stored transaction hash, ignores armed.
+    void load(const hash_digest& hash);
+
+    /// Answer queries and count changes from the filter, if allocated.
+    void arm();
+
+    /// True if the filter has been armed.
+    bool armed() const;
+
+    /// Count up a connected transaction hash, ignored if not armed.
+    void insert(const hash_digest& hash);
+
+    /// Count down a disconnected transaction hash, ignored if not armed.
+    void remove(const hash_digest& hash);
+
+    /// False only if the hash is not counted (or not armed).
+    bool may_contain(const hash_digest& hash) const;
+
+private:
+    typedef std::atomic<uint64_t> word;
+
+    static const size_t words_per_block = 8;
+    static const size_t hash_functions = 8;
+
+    static void count_up(word& counters, size_t shift);
+    static void count_down(word& counters, size_t shift);
+
+    size_t block_of(const hash_digest& hash) const;
+
+    const size_t headroom_;
+    size_t blocks_;
+    std::vector<word> words_;
+    std::atomic<bool> armed_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_INPUT_WORK_LIST_HPP
+#define LIBBITCOIN_BLOCKCHAIN_INPUT_WORK_LIST_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// A flat list of the non-coinbase inputs of a block, claimed in chunks by
+/// concurrent workers through a shared atomic cursor.
+class BCB_API input_work_list
+{
+public:
+    typedef std::shared_ptr<input_work_list> ptr;
+
+    struct item
+    {
+        uint32_t transaction;
+        uint32_t input;
+    };
+
+    typedef std::vector<item> list;
+    typedef list::const_iterator iterator;
+
+    /// Optionally skip inputs of txs pooled under current forks.
+    input_work_list(const chain::block& block, bool skip_current);
+
+    /// Claim the next chunk of up to size items, false if exhausted.
+    bool claim(size_t size, iterator& begin, iterator& end);
+
+    /// A chunk size that balances cursor contention with load balance.
+    size_t chunk_size(size_t workers) const;
+
+    /// The number of transactions skipped as current.
+    size_t skipped() const;
+
+    size_t size() const;
+    bool empty() const;
+
+private:
+    list items_;
+    size_t skipped_;
+    std::atomic<size_t> cursor_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
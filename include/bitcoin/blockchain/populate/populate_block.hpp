@@ -24,6 +24,7 @@
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/populate/input_work_list.hpp>
 #include <bitcoin/blockchain/populate/populate_base.hpp>
 
 namespace libbitcoin {
@@ -50,7 +51,8 @@ protected:
     ////    const chain::transaction& tx) const;
 
     void populate_transactions(branch::const_ptr branch, size_t bucket,
-        size_t buckets, result_handler handler) const;
+        size_t buckets, input_work_list::ptr work,
+        result_handler handler) const;
 
     void populate_prevout(branch_ptr branch,
         const chain::output_point& outpoint) const;
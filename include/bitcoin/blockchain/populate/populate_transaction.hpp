@@ -38,6 +38,11 @@ public:
     /// Populate validation state for the transaction.
     void populate(transaction_const_ptr tx, result_handler&& handler) const;
 
+    /// Populate validation state for a transaction of a disconnected block,
+    /// which remains stored as unconfirmed so is not itself a duplicate.
+    void populate(transaction_const_ptr tx, bool repool,
+        result_handler&& handler) const;
+
 protected:
     void populate_inputs(transaction_const_ptr tx, size_t chain_height,
         size_t bucket, size_t buckets, result_handler handler) const;
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_UNDO_CACHE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_UNDO_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// The prevouts spent by the most recently connected blocks, as populated by
+/// their validation. When a shallow reorganization disconnects one of these
+/// blocks its prevouts are unspent again, and are then read from memory by
+/// the revalidation of its transactions instead of from the store.
+class BCB_API undo_cache
+{
+public:
+    /// A zero depth disables the cache.
+    undo_cache(size_t depth);
+
+    /// Record the prevouts of a connected block, dropping the oldest record.
+    /// Restored outputs spent by the block are removed.
+    void connect(const chain::block& block);
+
+    /// Restore the prevouts of the recorded blocks as unspent, excluding
+    /// those created above the fork height. Replaces prior restorations.
+    void disconnect(const block_const_ptr_list& blocks, size_t fork_height);
+
+    /// Drop the restored prevouts of the disconnected blocks, once their
+    /// transactions have been revalidated.
+    void release(const block_const_ptr_list& blocks);
+
+    /// Get a restored output created at or below the branch height. As with
+    /// the store's output cache, queries that require confirmation are not
+    /// answered (the block population path reads the store).
+    bool find(chain::output& out_output, size_t& out_height,
+        uint32_t& out_median_time_past, bool& out_coinbase,
+        const chain::output_point& outpoint, size_t branch_height,
+        bool require_confirmed) const;
+
+    /// The number of recorded blocks.
+    size_t depth() const;
+
+    /// The number of restored outputs.
+    size_t size() const;
+
+private:
+    struct prevout
+    {
+        chain::output output;
+        size_t height;
+        uint32_t median_time_past;
+        bool coinbase;
+    };
+
+    struct record
+    {
+        hash_digest hash;
+        std::vector<std::pair<chain::point, prevout>> prevouts;
+    };
+
+    typedef std::deque<record> records;
+    typedef std::unordered_map<chain::point, prevout> outputs;
+
+    // This is thread safe.
+    const size_t depth_;
+
+    // This is set only while there are restored outputs.
+    std::atomic<bool> restoring_;
+
+    // These are protected by mutex.
+    records records_;
+    outputs restored_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -44,7 +44,30 @@ public:
     uint64_t minimum_output_satoshis;
     uint32_t notify_limit_hours;
     uint32_t reorganization_limit;
+    uint32_t script_cache_capacity;
+    uint32_t reject_filter_capacity;
+    uint32_t admission_queue_capacity;
+    /// Blocks awaiting organization (and awaiting simulation), beyond which
+    /// further blocks are rejected as oversubscribed.
+    uint32_t block_queue_capacity;
+    uint32_t pooled_transaction_capacity;
+    /// Transactions confirmed after startup that the duplicate filter is
+    /// sized for, in addition to those stored (zero disables the filter).
+    /// Disabled by default. The filter serves only confirmed (BIP30) queries,
+    /// which are not made under checkpoints or once collisions are allowed.
+    /// It costs five bytes per stored and headroom transaction (over a GB on
+    /// mainnet) and a scan of the block index on each startup.
+    uint32_t duplicate_filter_capacity;
+    /// Connected blocks whose prevouts are held in memory for the repooling
+    /// of their transactions if disconnected (zero disables the cache).
+    /// Each recorded block copies every prevout it spends, so this is one
+    /// by default, as a shallow reorganization is nearly always of one block.
+    /// Blocks are not recorded while the chain is stale (initial sync).
+    uint32_t undo_cache_depth;
     config::checkpoint::list checkpoints;
+    /// Scripts of its ancestors are not verified, and it is enforced as a
+    /// checkpoint (a block at its height with another hash is rejected).
+    config::checkpoint assume_valid;
     bool allow_collisions;
     bool easy_blocks;
     bool retarget;
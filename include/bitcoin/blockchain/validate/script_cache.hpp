@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_SCRIPT_CACHE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_SCRIPT_CACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_set>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// A bounded set of successful input script verifications, shared by pool
+/// and block validation. Entries are keyed on a salted digest of the
+/// transaction (witness) hash, input index and fork flags.
+class BCB_API script_cache
+{
+public:
+    /// A zero capacity disables the cache.
+    script_cache(size_t capacity);
+
+    /// True if the input script has been verified under the forks.
+    bool contains(const chain::transaction& tx, uint32_t input_index,
+        uint32_t forks) const;
+
+    /// Record a successful input script verification under the forks.
+    void store(const chain::transaction& tx, uint32_t input_index,
+        uint32_t forks);
+
+    /// The number of cached verifications.
+    size_t size() const;
+
+    /// Drop all cached verifications.
+    void clear();
+
+private:
+    typedef std::unordered_set<hash_digest> entries;
+    typedef std::deque<hash_digest> queue;
+
+    struct shard
+    {
+        entries set;
+        queue order;
+        mutable shared_mutex mutex;
+    };
+
+    static const size_t shard_count = 16;
+
+    hash_digest key(const chain::transaction& tx, uint32_t input_index,
+        uint32_t forks) const;
+    shard& select(const hash_digest& key) const;
+
+    // These are thread safe.
+    const size_t shard_capacity_;
+    const data_chunk salt_;
+
+    // These are protected by the shard mutex.
+    mutable std::array<shard, shard_count> shards_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -20,15 +20,19 @@
 #define LIBBITCOIN_BLOCKCHAIN_VALIDATE_BLOCK_HPP
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/populate/input_work_list.hpp>
 #include <bitcoin/blockchain/populate/populate_block.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
@@ -38,28 +42,89 @@ class BCB_API validate_block
 {
 public:
     typedef handle0 result_handler;
+    typedef std::chrono::microseconds duration;
+
+    /// Statistics of one block validation, merged from each worker.
+    struct statistics
+    {
+        size_t height;
+        size_t transactions;
+        size_t inputs;
+        size_t pooled;
+        size_t prevouts;
+        size_t cache_hits;
+        size_t verified;
+        size_t sigops;
+        duration check;
+        duration populate;
+        duration accept;
+        duration connect;
+    };
 
     validate_block(dispatcher& dispatch, const fast_chain& chain,
-        const settings& settings, bool relay_transactions);
+        const script_cache& cache, const settings& settings,
+        bool relay_transactions);
 
     void start();
     void stop();
 
+    /// Context free checks, thread safe.
     void check(block_const_ptr block, result_handler handler) const;
-    void accept(branch::const_ptr branch, result_handler handler) const;
+
+    /// Contextual header checks of the branch top, populates chain state.
+    code accept_header(branch::const_ptr branch) const;
+
+    /// Begins the statistics record of a checked block.
+    void accept(branch::const_ptr branch, duration checked,
+        result_handler handler) const;
     void connect(branch::const_ptr branch, result_handler handler) const;
 
+    /// Connect the top of a branch that is a prefix of the path (such as a
+    /// parked block), scripts may be assumed valid only by the path.
+    void connect(branch::const_ptr branch, branch::const_ptr path,
+        result_handler handler) const;
+
+    /// Statistics of the most recently connected block (thread safe).
+    statistics last_statistics() const;
+
+    /// The time since start in statistics units.
+    static duration elapsed(asio::time_point start);
+
+    /// True if the block at the height of the path is an ancestor of (or is)
+    /// the assumed valid block, given the top height of the store. The block
+    /// is enforced as a checkpoint, so a path that reaches neither its height
+    /// nor a store that reaches it can continue only through it.
+    static bool is_assumed_valid(const config::checkpoint& assume_valid,
+        size_t height, branch::const_ptr path, size_t top);
+
+    /// True if the block at the height is not the assumed valid block at its
+    /// height, such a block is rejected as a checkpoint conflict.
+    static bool is_assumed_valid_conflict(
+        const config::checkpoint& assume_valid, size_t height,
+        const hash_digest& hash);
+
 protected:
     inline bool stopped() const
     {
         return stopped_;
     }
 
-    float hit_rate() const;
-
 private:
-    typedef std::atomic<size_t> atomic_counter;
-    typedef std::shared_ptr<atomic_counter> atomic_counter_ptr;
+    // Each worker writes only its own record, merged after the join.
+    struct worker_statistics
+    {
+        size_t cache_hits;
+        size_t verified;
+        size_t sigops;
+    };
+
+    typedef std::vector<worker_statistics> worker_list;
+    typedef std::shared_ptr<worker_list> worker_list_ptr;
+
+    // Set by the first failing bucket of a phase, ends the others early.
+    typedef std::atomic<bool> cancel_token;
+    typedef std::shared_ptr<cancel_token> cancel_token_ptr;
+    typedef std::shared_ptr<data_stack> data_stack_ptr;
 
     static void dump(const code& ec, const chain::transaction& tx, uint32_t input_index, uint32_t forks, size_t height);
 
@@ -70,21 +135,40 @@ private:
     void handle_populated(const code& ec, block_const_ptr block,
         result_handler handler) const;
     void accept_transactions(block_const_ptr block, size_t bucket,
-        size_t buckets, atomic_counter_ptr sigops, bool bip16, bool bip141,
-        result_handler handler) const;
+        size_t buckets, worker_list_ptr workers, cancel_token_ptr cancel,
+        bool bip16, bool bip141, result_handler handler) const;
     void handle_accepted(const code& ec, block_const_ptr block,
-        atomic_counter_ptr sigops, bool bip141, result_handler handler) const;
-    void connect_inputs(block_const_ptr block, size_t bucket,
-        size_t buckets, result_handler handler) const;
-    void handle_connected(const code& ec, block_const_ptr block,
+        worker_list_ptr workers, bool bip141, result_handler handler) const;
+#ifdef WITH_CONSENSUS
+    void serialize_transactions(block_const_ptr block, size_t bucket,
+        size_t buckets, data_stack_ptr serials, result_handler handler) const;
+#endif
+    void handle_serialized(const code& ec, block_const_ptr block,
+        input_work_list::ptr work, data_stack_ptr serials,
+        result_handler handler) const;
+    void connect_inputs(block_const_ptr block, size_t bucket, size_t buckets,
+        input_work_list::ptr work, data_stack_ptr serials,
+        worker_list_ptr workers, cancel_token_ptr cancel,
         result_handler handler) const;
+    void handle_connected(const code& ec, block_const_ptr block,
+        worker_list_ptr workers, result_handler handler) const;
+    void publish() const;
+    bool is_assumed_valid(size_t height, branch::const_ptr path) const;
+    bool is_assumed_valid_conflict(block_const_ptr block) const;
 
     // These are thread safe.
     std::atomic<bool> stopped_;
     const fast_chain& fast_chain_;
     dispatcher& priority_dispatch_;
-    mutable atomic_counter hits_;
-    mutable atomic_counter queries_;
+    const script_cache& script_cache_;
+    const config::checkpoint assume_valid_;
+
+    // This is written only by the validation sequence in progress.
+    mutable statistics current_;
+
+    // This is protected by mutex.
+    mutable statistics last_;
+    mutable shared_mutex mutex_;
 
     // Caller must not invoke accept/connect concurrently.
     populate_block block_populator_;
@@ -43,8 +43,17 @@ public:
     code convert_result(consensus::verify_result_type result);
 #endif
 
+    /// The transaction wire serialization as required by verify_script.
+    static
+    data_chunk serialize(chain::transaction const& tx);
+
     static 
     code verify_script(chain::transaction const& tx, uint32_t input_index, uint32_t forks);
+
+    /// Verify against a precomputed tx serialization, reusing script_buffer.
+    static
+    code verify_script(chain::transaction const& tx, uint32_t input_index,
+        uint32_t forks, data_chunk const& tx_data, data_chunk& script_buffer);
 };
 
 } // namespace blockchain
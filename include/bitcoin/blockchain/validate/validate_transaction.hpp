@@ -21,12 +21,14 @@
 
 #include <atomic>
 #include <cstddef>
+#include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
 #include <bitcoin/blockchain/populate/populate_transaction.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
@@ -38,13 +40,22 @@ public:
     typedef handle0 result_handler;
 
     validate_transaction(dispatcher& dispatch, const fast_chain& chain,
-        const settings& settings);
+        script_cache& cache, const settings& settings);
 
     void start();
     void stop();
 
     void check(transaction_const_ptr tx, result_handler handler) const;
     void accept(transaction_const_ptr tx, result_handler handler) const;
+
+    /// Accept a tx of a disconnected block (if repool) for the pool.
+    void accept(transaction_const_ptr tx, bool repool,
+        result_handler handler) const;
+
+    /// The chain state and prevout population step of accept.
+    void populate(transaction_const_ptr tx, result_handler handler) const;
+    void populate(transaction_const_ptr tx, bool repool,
+        result_handler handler) const;
     void connect(transaction_const_ptr tx, result_handler handler) const;
 
 protected:
@@ -54,18 +65,23 @@ protected:
     }
 
 private:
+    typedef std::shared_ptr<const data_chunk> data_chunk_const_ptr;
+
     void handle_populated(const code& ec, transaction_const_ptr tx,
         result_handler handler) const;
     void connect_inputs(transaction_const_ptr tx, size_t bucket,
-        size_t buckets, result_handler handler) const;
+        size_t buckets, data_chunk_const_ptr tx_data,
+        result_handler handler) const;
 
     // These are thread safe.
     std::atomic<bool> stopped_;
     const bool retarget_;
     const fast_chain& fast_chain_;
     dispatcher& dispatch_;
+    script_cache& script_cache_;
 
-    // Caller must not invoke accept/connect concurrently.
+    // Population writes only the tx being validated, so accept/connect of
+    // distinct txs may run concurrently.
     populate_transaction transaction_populator_;
 };
 
@@ -76,16 +76,24 @@ block_chain::block_chain(threadpool& pool,
   : stopped_(true),
     settings_(chain_settings),
     notify_limit_seconds_(chain_settings.notify_limit_hours * hour_seconds),
+    reorganization_sequence_(0),
     chain_state_populator_(*this, chain_settings),
     database_(database_settings),
     validation_mutex_(database_settings.flush_writes && relay_transactions),
     priority_pool_(thread_ceiling(chain_settings.cores),
         priority(chain_settings.priority)),
     dispatch_(priority_pool_, NAME "_priority"),
+    script_cache_(chain_settings.script_cache_capacity),
+    pooled_transactions_(chain_settings.pooled_transaction_capacity),
+    duplicate_filter_(chain_settings.duplicate_filter_capacity),
+    duplicate_fork_height_(max_size_t),
+    loader_pool_(1),
+    loader_dispatch_(loader_pool_, NAME "_loader"),
+    undo_cache_(chain_settings.undo_cache_depth),
     transaction_organizer_(validation_mutex_, dispatch_, pool, *this,
-        chain_settings),
-    block_organizer_(validation_mutex_, dispatch_, pool, *this, chain_settings,
-        relay_transactions),
+        script_cache_, chain_settings),
+    block_organizer_(validation_mutex_, dispatch_, pool, *this,
+        script_cache_, chain_settings, relay_transactions),
     chosen_size_(0),
     chosen_sigops_(0),
     chosen_unconfirmed_(),
@@ -218,6 +226,11 @@ bool block_chain::get_output(chain::output& out_output, size_t& out_height,
     const chain::output_point& outpoint, size_t branch_height,
     bool require_confirmed) const
 {
+    // Outputs unspent again by a recent reorganization are held in memory.
+    if (undo_cache_.find(out_output, out_height, out_median_time_past,
+        out_coinbase, outpoint, branch_height, require_confirmed))
+        return true;
+
     // This includes a cached value for spender height (or not_spent).
     // Get the highest tx with matching hash, at or below the branch height.
     return database_.transactions().get_output(out_output, out_height,
@@ -238,6 +251,11 @@ bool block_chain::get_output_is_confirmed(chain::output& out_output, size_t& out
 bool block_chain::get_is_unspent_transaction(const hash_digest& hash,
     size_t branch_height, bool require_confirmed) const
 {
+    // Only probable confirmed hits touch the store. Popped transactions
+    // remain stored as unconfirmed, so those queries are not filtered.
+    if (require_confirmed && !duplicate_filter_.may_contain(hash))
+        return false;
+
     const auto result = database_.transactions().get(hash, branch_height,
         require_confirmed);
 
@@ -259,6 +277,30 @@ bool block_chain::get_transaction_position(size_t& out_height,
     return true;
 }
 
+bool block_chain::get_pooled_forks(uint32_t& out_forks,
+    const hash_digest& hash) const
+{
+    bool fresh;
+
+    if (!pooled_transactions_.find(out_forks, fresh, hash))
+        return false;
+
+    // Confirmation removes an entry, so only disconnection stales it.
+    if (fresh)
+        return true;
+
+    size_t height;
+    size_t position;
+
+    // A stale entry is a hint, confirmed as unconfirmed by the store.
+    if (!get_transaction_position(height, position, hash, false) ||
+        position != transaction_database::unconfirmed)
+        return false;
+
+    out_forks = static_cast<uint32_t>(height);
+    return true;
+}
+
 ////transaction_ptr block_chain::get_transaction(size_t& out_block_height,
 ////    const hash_digest& hash, bool require_confirmed) const
 ////{
@@ -287,16 +329,29 @@ bool block_chain::end_insert() const
 
 bool block_chain::insert(block_const_ptr block, size_t height)
 {
-    return database_.insert(*block, height) == error::success;
+    if (database_.insert(*block, height) != error::success)
+        return false;
+
+    for (const auto& tx: block->transactions())
+        duplicate_filter_.insert(tx.hash());
+
+    undo_cache_.connect(*block);
+    return true;
 }
 
 void block_chain::push(transaction_const_ptr tx, dispatcher&,
     result_handler handler)
 {
     last_transaction_.store(tx);
+    const auto forks = chain_state()->enabled_forks();
 
     // Transaction push is currently sequential so dispatch is not used.
-    handler(database_.push(*tx, chain_state()->enabled_forks()));
+    const auto ec = database_.push(*tx, forks);
+
+    if (!ec)
+        pooled_transactions_.add(tx->hash(), forks);
+
+    handler(ec);
 }
 
 
@@ -585,21 +640,67 @@ void block_chain::reorganize(const checkpoint& fork_point,
     // The top (back) block is used to update the chain state.
     const auto complete =
         std::bind(&block_chain::handle_reorganize,
-            this, _1, incoming_blocks->back(), handler);
+            this, _1, incoming_blocks, outgoing_blocks, fork_point.height(),
+            handler);
+
+    // Odd until the store write completes, successful or not.
+    ++reorganization_sequence_;
 
     database_.reorganize(fork_point, incoming_blocks, outgoing_blocks,
         dispatch, complete);
 }
 
-void block_chain::handle_reorganize(const code& ec, block_const_ptr top,
+void block_chain::handle_reorganize(const code& ec,
+    block_const_ptr_list_const_ptr incoming_blocks,
+    block_const_ptr_list_const_ptr outgoing_blocks, size_t fork_height,
     result_handler handler)
 {
+    ++reorganization_sequence_;
+
+    // Confirmed txs are no longer pooled, on failure the store is corrupt.
+    for (const auto block: *incoming_blocks)
+    {
+        for (const auto& tx: block->transactions())
+        {
+            pooled_transactions_.remove(tx.hash());
+            duplicate_filter_.insert(tx.hash());
+        }
+    }
+
+    // Disconnected txs are no longer confirmed.
+    for (const auto block: *outgoing_blocks)
+        for (const auto& tx: block->transactions())
+            duplicate_filter_.remove(tx.hash());
+
+    // Blocks above the fork point may have been loaded before this.
+    if (!duplicate_filter_.armed())
+        duplicate_fork_height_ = std::min(duplicate_fork_height_, fork_height);
+
+    // The store's handling of popped txs is not observed, so pooled entries
+    // become hints to be confirmed by the store.
+    if (!outgoing_blocks->empty())
+        pooled_transactions_.invalidate();
+
     if (ec)
     {
         handler(ec);
         return;
     }
 
+    // Prevouts of disconnected blocks are restored before those of the
+    // connected blocks are recorded (and their restored spends removed).
+    undo_cache_.disconnect(*outgoing_blocks, fork_height);
+
+    // The prevouts serve only repooling, so are not copied during sync.
+    // Restored outputs spent by the blocks are removed in either case.
+    if (is_stale())
+        undo_cache_.release(*incoming_blocks);
+    else
+        for (const auto block: *incoming_blocks)
+            undo_cache_.connect(*block);
+
+    const auto top = incoming_blocks->back();
+
     if (!top->validation.state)
     {
         handler(error::operation_failed_14);
@@ -612,10 +713,52 @@ void block_chain::handle_reorganize(const code& ec, block_const_ptr top,
     handler(error::success);
 }
 
+// This is invoked within the block organizer critical section.
+bool block_chain::handle_reorganized(code ec, size_t,
+    block_const_ptr_list_const_ptr incoming,
+    block_const_ptr_list_const_ptr outgoing)
+{
+    if (stopped() || ec == error::service_stopped)
+        return false;
+
+    if (ec)
+    {
+        LOG_ERROR(LOG_BLOCKCHAIN)
+            << "Failure in reorganization handler: " << ec.message();
+        return false;
+    }
+
+    // Unsubscribe is signaled by an empty branch.
+    if (!incoming || incoming->empty())
+        return false;
+
+    // Rejections are recorded against the previous tip.
+    transaction_organizer_.reset_rejects();
+
+    // The tx organizer continues outside of the critical section.
+    transaction_organizer_.repool(outgoing,
+        std::bind(&block_chain::handle_repooled,
+            this, _1, outgoing));
+
+    return true;
+}
+
+void block_chain::handle_repooled(const code& ec,
+    block_const_ptr_list_const_ptr outgoing)
+{
+    // Restored prevouts serve only the revalidation of outgoing txs.
+    if (outgoing)
+        undo_cache_.release(*outgoing);
+
+    if (ec && ec != error::service_stopped)
+        LOG_ERROR(LOG_BLOCKCHAIN)
+            << "Failure repooling reorganized transactions: " << ec.message();
+}
+
 // Properties.
 // ----------------------------------------------------------------------------
 
-// For tx validator, call only from inside validate critical section.
+// For tx validator, safe to call outside of the validate critical section.
 chain::chain_state::ptr block_chain::chain_state() const
 {
     // Critical Section
@@ -637,6 +780,11 @@ chain::chain_state::ptr block_chain::chain_state(
     return chain_state_populator_.populate(chain_state(), branch);
 }
 
+size_t block_chain::reorganization_sequence() const
+{
+    return reorganization_sequence_;
+}
+
 // private.
 code block_chain::set_chain_state(chain::chain_state::ptr previous)
 {
@@ -666,8 +814,20 @@ bool block_chain::start()
     // Initialize chain state after database start but before organizers.
     pool_state_ = chain_state_populator_.populate();
 
-    return pool_state_ && transaction_organizer_.start() &&
-        block_organizer_.start();
+    // The duplicate filter loads from the block index as blocks organize.
+    if (duplicate_filter_.enabled())
+        loader_dispatch_.concurrent(&block_chain::load_duplicate_filter, this);
+
+    if (!pool_state_ || !transaction_organizer_.start() ||
+        !block_organizer_.start())
+        return false;
+
+    // Transactions of blocks reorganized out are returned to the pool.
+    block_organizer_.subscribe(
+        std::bind(&block_chain::handle_reorganized,
+            this, _1, _2, _3, _4));
+
+    return true;
 }
 
 bool block_chain::stop()
@@ -681,7 +841,8 @@ bool block_chain::stop()
     // This cannot call organize or stop (lock safe).
     auto result = transaction_organizer_.stop() && block_organizer_.stop();
 
-    // The priority pool must not be stopped while organizing.
+    // The priority pool must not be stopped while organizing. Organizer
+    // work outside of this critical section is awaited by its stop.
     priority_pool_.shutdown();
 
     validation_mutex_.unlock_high_priority();
@@ -695,9 +856,91 @@ bool block_chain::close()
 {
     const auto result = stop();
     priority_pool_.join();
+    loader_pool_.shutdown();
+    loader_pool_.join();
     return result && database_.close();
 }
 
+// private
+// The filter must count every confirmed tx before it is armed. Blocks stored
+// while loading (including into gaps) and above a reorganized fork point are
+// loaded again once armed, a double count is only a false positive.
+void block_chain::load_duplicate_filter()
+{
+    size_t top;
+
+    if (!get_last_height(top))
+        return;
+
+    const auto& blocks = database_.blocks();
+    size_t stored = 0;
+
+    // The filter is sized from the index before loading.
+    for (size_t height = 0; height <= top && !stopped(); ++height)
+    {
+        const auto result = blocks.get(height);
+
+        if (result)
+            stored += result.transaction_count();
+    }
+
+    duplicate_filter_.allocate(stored);
+    block_database::heights unloaded;
+
+    for (size_t height = 0; height <= top && !stopped(); ++height)
+    {
+        const auto result = blocks.get(height);
+
+        if (!result)
+        {
+            unloaded.push_back(height);
+            continue;
+        }
+
+        for (const auto& hash: result.transaction_hashes())
+            duplicate_filter_.load(hash);
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    validation_mutex_.lock_low_priority();
+
+    if (stopped())
+    {
+        validation_mutex_.unlock_low_priority();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    // Reorganization is excluded, inserts are counted from here.
+    duplicate_filter_.arm();
+    const auto fork_height = std::min(top, duplicate_fork_height_);
+
+    for (auto height = fork_height + 1u; height <= top; ++height)
+        unloaded.push_back(height);
+
+    size_t last;
+
+    if (get_last_height(last))
+        for (auto height = top + 1u; height <= last; ++height)
+            unloaded.push_back(height);
+
+    for (const auto height: unloaded)
+    {
+        const auto result = blocks.get(height);
+
+        if (result)
+            for (const auto& hash: result.transaction_hashes())
+                duplicate_filter_.insert(hash);
+    }
+
+    validation_mutex_.unlock_low_priority();
+    ///////////////////////////////////////////////////////////////////////////
+
+    LOG_INFO(LOG_BLOCKCHAIN)
+        << "Duplicate filter loaded (" << stored << ") transactions.";
+}
+
 block_chain::~block_chain()
 {
     close();
@@ -1600,19 +1843,15 @@ void block_chain::filter_blocks(get_data_ptr message,
         return;
     }
 
-    // Filter through block pool first.
-    block_organizer_.filter(message);
-    auto& inventories = message->inventories();
     const auto& blocks = database_.blocks();
 
-    for (auto it = inventories.begin(); it != inventories.end();)
+    const auto stored = [&blocks](const hash_digest& hash)
     {
-        if (it->is_block_type() && blocks.get(it->hash()))
-            it = inventories.erase(it);
-        else
-            ++it;
-    }
+        return static_cast<bool>(blocks.get(hash));
+    };
 
+    // Filter through block pool and store in one pass.
+    block_organizer_.filter(message, stored);
     handler(error::success);
 }
 
@@ -1627,16 +1866,16 @@ void block_chain::filter_transactions(get_data_ptr message,
     }
 
     auto& inventories = message->inventories();
-    const auto& transactions = database_.transactions();
 
-    for (auto it = inventories.begin(); it != inventories.end();)
+    const auto found = [this](const inventory_vector& inventory)
     {
-        if (it->is_transaction_type() &&
-            get_is_unspent_transaction(it->hash(), max_size_t, false))
-            it = inventories.erase(it);
-        else
-            ++it;
-    }
+        return inventory.is_transaction_type() &&
+            get_is_unspent_transaction(inventory.hash(), max_size_t, false);
+    };
+
+    // Compact in place, linear in the number of inventories.
+    inventories.erase(std::remove_if(inventories.begin(), inventories.end(),
+        found), inventories.end());
 
     handler(error::success);
 }
@@ -1684,10 +1923,43 @@ void block_chain::organize(transaction_const_ptr tx, result_handler handler)
     transaction_organizer_.organize(tx, handler);
 }
 
+void block_chain::organize(transaction_const_ptr_list txs,
+    transaction_organizer::batch_handler handler)
+{
+    // This cannot call organize or stop (lock safe).
+    transaction_organizer_.organize(txs, handler);
+}
+
 
 // Properties (thread safe).
 // ----------------------------------------------------------------------------
 
+transaction_organizer::admission_statistics block_chain::admission_stats() const
+{
+    return transaction_organizer_.admission_stats();
+}
+
+latency_histogram::summary block_chain::transaction_latency(
+    transaction_organizer::stage step) const
+{
+    return transaction_organizer_.latency(step);
+}
+
+validate_block::statistics block_chain::block_validation_statistics() const
+{
+    return block_organizer_.validation_statistics();
+}
+
+hash_list block_chain::queued_blocks() const
+{
+    return block_organizer_.queued();
+}
+
+bool block_chain::cancel_block(const hash_digest& hash)
+{
+    return block_organizer_.cancel(hash);
+}
+
 bool block_chain::is_stale() const
 {
     // If there is no limit set the chain is never considered stale.
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/admission_queue.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace std::chrono;
+
+admission_queue::admission_queue(size_t capacity, size_t concurrency)
+  : capacity_(capacity),
+    concurrency_(std::max(concurrency, size_t(1))),
+    stopped_(false),
+    active_(0),
+    admitted_(0),
+    shed_(0),
+    sequence_(0),
+    total_wait_(duration::zero()),
+    maximum_wait_(duration::zero())
+{
+}
+
+// private
+// Call only from inside the critical section.
+bool admission_queue::admissible(const ticket& self) const
+{
+    return active_ < concurrency_ && *pending_.begin() == &self;
+}
+
+code admission_queue::enter(uint64_t priority)
+{
+    const auto start = steady_clock::now();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (stopped_)
+        return error::service_stopped;
+
+    // Admit immediately if a slot is free and nothing is waiting.
+    if (pending_.empty() && active_ < concurrency_)
+    {
+        ++active_;
+        ++admitted_;
+        return error::success;
+    }
+
+    if (pending_.size() >= capacity_)
+    {
+        // Shed this entry if it does not outrank the lowest waiter.
+        if (pending_.empty() || (*pending_.rbegin())->priority >= priority)
+        {
+            ++shed_;
+            return error::oversubscribed;
+        }
+
+        const auto lowest = std::prev(pending_.end());
+        (*lowest)->shed = true;
+        pending_.erase(lowest);
+        ++shed_;
+
+        // Wake the shed waiter.
+        condition_.notify_all();
+    }
+
+    ticket self{ priority, sequence_++, false };
+    pending_.insert(&self);
+
+    condition_.wait(lock, [this, &self]()
+    {
+        return stopped_ || self.shed || admissible(self);
+    });
+
+    // A shed ticket has already been removed from the queue.
+    if (self.shed)
+        return error::oversubscribed;
+
+    pending_.erase(&self);
+
+    if (stopped_)
+        return error::service_stopped;
+
+    const auto waited = duration_cast<duration>(steady_clock::now() - start);
+    total_wait_ += waited;
+    maximum_wait_ = std::max(maximum_wait_, waited);
+    ++active_;
+    ++admitted_;
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The next waiter may also be admissible.
+    condition_.notify_all();
+    return error::success;
+}
+
+void admission_queue::leave()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    BITCOIN_ASSERT(active_ != 0);
+    --active_;
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    condition_.notify_all();
+}
+
+void admission_queue::stop()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopped_ = true;
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    condition_.notify_all();
+}
+
+admission_queue::statistics admission_queue::stats() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Immediate admissions are counted with zero wait.
+    const auto average = admitted_ == 0 ? duration::zero() :
+        total_wait_ / admitted_;
+
+    return
+    {
+        pending_.size(), active_, admitted_, shed_, average, maximum_wait_
+    };
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -18,10 +18,14 @@
  */
 #include <bitcoin/blockchain/pools/block_organizer.hpp>
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
@@ -39,6 +43,10 @@ using namespace std::placeholders;
 
 #define NAME "block_organizer"
 
+// One thread drains the queue, simulations are serialized on their own.
+static const size_t organizer_threads = 1;
+static const size_t simulate_threads = 1;
+
 // Database access is limited to: push, pop, last-height, branch-work,
 // validator->populator:
 // spend: { spender }
@@ -46,15 +54,23 @@ using namespace std::placeholders;
 // transaction: { exists, height, output }
 
 block_organizer::block_organizer(prioritized_mutex& mutex, dispatcher& dispatch,
-    threadpool& thread_pool, fast_chain& chain,  const settings& settings,
-    bool relay_transactions)
+    threadpool& thread_pool, fast_chain& chain, const script_cache& cache,
+    const settings& settings, bool relay_transactions)
   : fast_chain_(chain),
+    parked_(settings.reorganization_limit),
     mutex_(mutex),
     stopped_(true),
+    queue_capacity_(settings.block_queue_capacity),
     dispatch_(dispatch),
     block_pool_(settings.reorganization_limit),
-    validator_(dispatch, fast_chain_, settings, relay_transactions),
-    subscriber_(std::make_shared<reorganize_subscriber>(thread_pool, NAME))
+    validator_(dispatch, fast_chain_, cache, settings, relay_transactions),
+    simulator_(dispatch, fast_chain_, cache, settings, relay_transactions),
+    subscriber_(std::make_shared<reorganize_subscriber>(thread_pool, NAME)),
+    draining_(false),
+    organizer_pool_(organizer_threads),
+    simulate_pool_(simulate_threads),
+    organize_dispatch_(organizer_pool_, NAME "_organize"),
+    simulate_dispatch_(simulate_pool_, NAME "_simulate")
 {
 }
 
@@ -66,6 +82,11 @@ bool block_organizer::stopped() const
     return stopped_;
 }
 
+validate_block::statistics block_organizer::validation_statistics() const
+{
+    return validator_.last_statistics();
+}
+
 // Start/stop sequences.
 //-----------------------------------------------------------------------------
 
@@ -74,15 +95,49 @@ bool block_organizer::start()
     stopped_ = false;
     subscriber_->start();
     validator_.start();
+    simulator_.start();
     return true;
 }
 
+// This is called from within the organizer critical section.
 bool block_organizer::stop()
 {
     validator_.stop();
+    simulator_.stop();
     subscriber_->stop();
     subscriber_->invoke(error::service_stopped, 0, {}, {});
+
+    block_queue canceled;
+    block_queue unsimulated;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    queue_mutex_.lock();
     stopped_ = true;
+    canceled.swap(queue_);
+    unsimulated.swap(simulations_);
+    queue_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Critical Section (simulations)
+    ///////////////////////////////////////////////////////////////////////////
+    // A simulation also runs on the priority pool, and ends early as the
+    // simulator is stopped. Any that follows finds the organizer stopped.
+    simulate_mutex_.lock();
+    simulate_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Queued blocks are not organized, pending simulations are not run.
+    // Shutdown discards their dispatched jobs, which would find none.
+    for (const auto& queued: canceled)
+        queued.handler(error::service_stopped);
+
+    for (const auto& queued: unsimulated)
+        queued.handler(error::service_stopped);
+
+    // The organizer threads are joined on destruct.
+    organizer_pool_.shutdown();
+    simulate_pool_.shutdown();
     return true;
 }
 
@@ -90,51 +145,329 @@ bool block_organizer::stop()
 //-----------------------------------------------------------------------------
 
 // This is called from block_chain::organize.
+// This returns immediately, the handler is invoked from an organizer thread.
 void block_organizer::organize(block_const_ptr block, result_handler handler)
 {
+    // Simulated blocks on the store are validated outside of the critical
+    // section, others are queued in order.
+    if (!block->validation.simulate)
+    {
+        enqueue(block, handler);
+        return;
+    }
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_high_priority();
+    queue_mutex_.lock();
 
     if (stopped())
     {
-        mutex_.unlock_high_priority();
+        queue_mutex_.unlock();
+        //---------------------------------------------------------------------
+        handler(error::service_stopped);
+        return;
+    }
+
+    if (simulations_.size() >= queue_capacity_)
+    {
+        queue_mutex_.unlock();
+        //---------------------------------------------------------------------
+        handler(error::oversubscribed);
+        return;
+    }
+
+    simulations_.push_back({ block, handler });
+
+    queue_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Each dispatch runs one pending simulation, if not failed by stop.
+    simulate_dispatch_.concurrent(&block_organizer::do_simulate, this);
+}
+
+// private
+void block_organizer::do_simulate()
+{
+    queued_block next;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    queue_mutex_.lock();
+
+    if (simulations_.empty())
+    {
+        queue_mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    next = std::move(simulations_.front());
+    simulations_.pop_front();
+
+    queue_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    code ec;
+
+    if (simulate(next.block, ec))
+    {
+        next.handler(ec);
+        return;
+    }
+
+    enqueue(next.block, next.handler);
+}
+
+// private
+// Queued blocks are organized in order of arrival by a single drain.
+void block_organizer::enqueue(block_const_ptr block, result_handler handler)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    queue_mutex_.lock();
+
+    if (stopped())
+    {
+        queue_mutex_.unlock();
+        //---------------------------------------------------------------------
         handler(error::service_stopped);
         return;
     }
 
-    // Reset the reusable promise.
-    resume_ = std::promise<code>();
+    // The caller is not parked, so memory is bounded by rejecting blocks.
+    if (queue_.size() >= queue_capacity_)
+    {
+        queue_mutex_.unlock();
+        //---------------------------------------------------------------------
+        handler(error::oversubscribed);
+        return;
+    }
+
+    queue_.push_back({ block, handler });
+    const auto drain = !draining_;
+    draining_ = true;
+
+    queue_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (drain)
+        organize_dispatch_.concurrent(&block_organizer::drain, this);
+}
+
+// private
+// This runs on an organizer thread until the queue is empty.
+void block_organizer::drain()
+{
+    while (true)
+    {
+        queued_block next;
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        queue_mutex_.lock();
+
+        if (queue_.empty())
+        {
+            draining_ = false;
+            queue_mutex_.unlock();
+            return;
+        }
+
+        next = std::move(queue_.front());
+        queue_.pop_front();
+
+        queue_mutex_.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        organize(next);
+    }
+}
+
+// private
+void block_organizer::organize(const queued_block& queued)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_high_priority();
 
-    const result_handler complete =
-        std::bind(&block_organizer::signal_completion,
-            this, _1);
+    if (stopped())
+    {
+        mutex_.unlock_high_priority();
+        //---------------------------------------------------------------------
+        queued.handler(error::service_stopped);
+        return;
+    }
 
-    const auto check_handler =
-        std::bind(&block_organizer::handle_check,
-            this, _1, block, complete);
+    const auto start = asio::steady_clock::now();
+    std::promise<code> checked_promise;
 
     // Checks that are independent of chain state.
-    validator_.check(block, check_handler);
+    validator_.check(queued.block,
+        std::bind(&block_organizer::signal,
+            _1, std::ref(checked_promise)));
+
+    auto ec = checked_promise.get_future().get();
+    const auto checked = validate_block::elapsed(start);
+    std::promise<code> complete;
+
+    handle_check(ec, queued.block, checked,
+        std::bind(&block_organizer::signal,
+            _1, std::ref(complete)));
 
     // Wait on completion signal.
     // This is necessary in order to continue on a non-priority thread.
     // If we do not wait on the original thread there may be none left.
-    auto ec = resume_.get_future().get();
+    ec = complete.get_future().get();
 
     mutex_.unlock_high_priority();
     ///////////////////////////////////////////////////////////////////////////
 
     // Invoke caller handler outside of critical section.
-    handler(ec);
+    queued.handler(ec);
 }
 
 // private
-void block_organizer::signal_completion(const code& ec)
+void block_organizer::signal(const code& ec, std::promise<code>& promise)
+{
+    promise.set_value(ec);
+}
+
+// Queue.
+//-----------------------------------------------------------------------------
+
+hash_list block_organizer::queued() const
+{
+    hash_list hashes;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    queue_mutex_.lock();
+    hashes.reserve(queue_.size());
+
+    for (const auto& queued: queue_)
+        hashes.push_back(queued.block->hash());
+
+    queue_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return hashes;
+}
+
+bool block_organizer::cancel(const hash_digest& hash)
 {
-    // This must be protected so that it is properly cleared.
-    // Signal completion, which results in original handler invoke with code.
-    resume_.set_value(ec);
+    const auto match = [&hash](const queued_block& queued)
+    {
+        return queued.block->hash() == hash;
+    };
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    queue_mutex_.lock();
+
+    const auto it = std::find_if(queue_.begin(), queue_.end(), match);
+
+    if (it == queue_.end())
+    {
+        queue_mutex_.unlock();
+        //---------------------------------------------------------------------
+        return false;
+    }
+
+    const auto handler = std::move(it->handler);
+    queue_.erase(it);
+
+    queue_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    handler(error::operation_failed);
+    return true;
+}
+
+// Simulate sequence.
+//-----------------------------------------------------------------------------
+// A simulated block that extends the store is validated as a branch of one
+// block, read-only and without the block pool, concurrent to organization.
+// Its reads are only consistent if no reorganization overlaps them.
+
+// private
+// False if the block must instead be simulated in the critical section.
+bool block_organizer::simulate(block_const_ptr block, code& out_ec)
+{
+    // Critical Section (simulations)
+    ///////////////////////////////////////////////////////////////////////////
+    std::lock_guard<std::mutex> lock(simulate_mutex_);
+
+    if (stopped())
+    {
+        out_ec = error::service_stopped;
+        return true;
+    }
+
+    // A reorganization in progress (odd) would be observed partially written.
+    const auto sequence = fast_chain_.reorganization_sequence();
+
+    if (sequence % 2 != 0)
+        return false;
+
+    const auto branch = std::make_shared<blockchain::branch>();
+    branch->push_front(block);
+
+    if (fast_chain_.get_block_exists(block->hash()))
+    {
+        out_ec = error::duplicate_block;
+        return true;
+    }
+
+    // A parent in the block pool requires the pool path.
+    if (!set_branch_height(branch))
+        return false;
+
+    out_ec = simulate(branch);
+
+    // A reorganization during the simulation may have invalidated its reads.
+    return fast_chain_.reorganization_sequence() == sequence;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Blocks the calling thread until the simulation completes.
+code block_organizer::simulate(branch::ptr branch)
+{
+    const auto block = branch->top();
+    const auto start = asio::steady_clock::now();
+    std::promise<code> checked;
+    std::promise<code> accepted;
+    std::promise<code> connected;
+
+    simulator_.check(block,
+        std::bind(&block_organizer::signal,
+            _1, std::ref(checked)));
+
+    auto ec = checked.get_future().get();
+
+    if (ec)
+        return ec;
+
+    simulator_.accept(branch, validate_block::elapsed(start),
+        std::bind(&block_organizer::signal,
+            _1, std::ref(accepted)));
+
+    if ((ec = accepted.get_future().get()))
+        return ec;
+
+    simulator_.connect(branch,
+        std::bind(&block_organizer::signal,
+            _1, std::ref(connected)));
+
+    if ((ec = connected.get_future().get()))
+        return ec;
+
+    bool sufficient;
+
+    if (!get_sufficient_work(sufficient, branch))
+        return error::operation_failed_18;
+
+    return sufficient ? error::success : error::insufficient_work;
 }
 
 // Verify sub-sequence.
@@ -142,7 +475,7 @@ void block_organizer::signal_completion(const code& ec)
 
 // private
 void block_organizer::handle_check(const code& ec, block_const_ptr block,
-    result_handler handler)
+    validate_block::duration checked, result_handler handler)
 {
     if (stopped())
     {
@@ -156,7 +489,7 @@ void block_organizer::handle_check(const code& ec, block_const_ptr block,
         return;
     }
 
-    // Verify the last branch block (all others are verified).
+    // Verify the last branch block (others are verified or parked).
     // Get the path through the block forest to the new block.
     const auto branch = block_pool_.get_path(block);
 
@@ -178,17 +511,126 @@ void block_organizer::handle_check(const code& ec, block_const_ptr block,
         return;
     }
 
+    // A block that extends a failed parked block is also invalid.
+    const auto parked_error = parked_.get_error(branch);
+
+    if (parked_error)
+    {
+        handler(parked_error);
+        return;
+    }
+
+    bool sufficient;
+
+    // Claimed work is compared before any body validation. The chain cannot
+    // change within the critical section, so the result is reused on connect.
+    if (!get_sufficient_work(sufficient, branch))
+    {
+        handler(error::operation_failed_18);
+        return;
+    }
+
+    // Simulated blocks are fully validated regardless of work.
+    if (!sufficient && !branch->top()->validation.simulate)
+    {
+        handler(park(branch));
+        return;
+    }
+
+    verify(branch, 0, sufficient, checked, handler);
+}
+
+// private
+// Validate parked blocks of the branch in order, then the top block.
+void block_organizer::verify(branch::ptr branch, size_t index,
+    bool sufficient, validate_block::duration checked, result_handler handler)
+{
+    const auto& blocks = *branch->blocks();
+    const auto top = blocks.size() - 1u;
+
+    // Pooled blocks not parked were validated on arrival.
+    while (index < top && !parked_.is_parked(blocks[index]->hash()))
+        ++index;
+
+    if (index == top)
+    {
+        const auto accept_handler =
+            std::bind(&block_organizer::handle_accept,
+                this, _1, branch, sufficient, handler);
+
+        // Checks that are dependent on chain state and prevouts.
+        validator_.accept(branch, checked, accept_handler);
+        return;
+    }
+
+    // A parked block is validated as the top of its own branch.
+    const auto parked = parked_blocks::get_prefix(branch, index);
+
     const auto accept_handler =
-        std::bind(&block_organizer::handle_accept,
-            this, _1, branch, handler);
+        std::bind(&block_organizer::handle_parked_accept,
+            this, _1, parked, branch, index, sufficient, checked, handler);
 
-    // Checks that are dependent on chain state and prevouts.
-    validator_.accept(branch, accept_handler);
+    // The parked block was checked on arrival.
+    validator_.accept(parked, validate_block::duration::zero(),
+        accept_handler);
+}
+
+// private
+void block_organizer::handle_parked_accept(const code& ec, branch::ptr parked,
+    branch::ptr branch, size_t index, bool sufficient,
+    validate_block::duration checked, result_handler handler)
+{
+    if (stopped())
+    {
+        handler(error::service_stopped);
+        return;
+    }
+
+    if (ec)
+    {
+        handle_parked_connect(ec, parked, branch, index, sufficient, checked,
+            handler);
+        return;
+    }
+
+    const auto connect_handler =
+        std::bind(&block_organizer::handle_parked_connect,
+            this, _1, parked, branch, index, sufficient, checked, handler);
+
+    // Checks that include script validation, scripts may be assumed valid
+    // only if the branch is on the path to the assumed valid block.
+    validator_.connect(parked, branch, connect_handler);
+}
+
+// private
+void block_organizer::handle_parked_connect(const code& ec, branch::ptr parked,
+    branch::ptr branch, size_t index, bool sufficient,
+    validate_block::duration checked, result_handler handler)
+{
+    if (stopped())
+    {
+        handler(error::service_stopped);
+        return;
+    }
+
+    const auto hash = parked->top()->hash();
+
+    // The parked block remains pooled, so a consensus failure is retained.
+    if (ec)
+    {
+        parked_.fail(hash, ec);
+        handler(ec);
+        return;
+    }
+
+    parked->top()->validation.error = error::success;
+    parked_.unpark(hash);
+    verify(branch, index + 1u, sufficient, checked, handler);
 }
 
 // private
 void block_organizer::handle_accept(const code& ec, branch::ptr branch,
-    result_handler handler)
+    bool sufficient, result_handler handler)
 {
     if (stopped())
     {
@@ -204,7 +646,7 @@ void block_organizer::handle_accept(const code& ec, branch::ptr branch,
 
     const auto connect_handler =
         std::bind(&block_organizer::handle_connect,
-            this, _1, branch, handler);
+            this, _1, branch, sufficient, handler);
 
     // Checks that include script validation.
     validator_.connect(branch, connect_handler);
@@ -212,7 +654,7 @@ void block_organizer::handle_accept(const code& ec, branch::ptr branch,
 
 // private
 void block_organizer::handle_connect(const code& ec, branch::ptr branch,
-    result_handler handler)
+    bool sufficient, result_handler handler)
 {
     if (stopped())
     {
@@ -232,21 +674,10 @@ void block_organizer::handle_connect(const code& ec, branch::ptr branch,
     auto& top_header = branch->top()->header().validation;
     top_header.median_time_past = top_block.state->median_time_past();
     top_header.height = branch->top_height();
-
-    uint256_t threshold;
-    const auto work = branch->work();
-    const auto first_height = branch->height() + 1u;
     top_block.start_notify = asio::steady_clock::now();
 
-    // The chain query will stop if it reaches work level.
-    if (!fast_chain_.get_branch_work(threshold, work, first_height))
-    {
-        handler(error::operation_failed_18);
-        return;
-    }
-
     // TODO: consider relay of pooled blocks by modifying subscriber semantics.
-    if (work <= threshold)
+    if (!sufficient)
     {
         if (!top_block.simulate)
             block_pool_.add(branch->top());
@@ -255,7 +686,7 @@ void block_organizer::handle_connect(const code& ec, branch::ptr branch,
         return;
     }
 
-    // TODO: create a simulated validation path that does not block others.
+    // Simulated blocks reach here only when not simulated on the store.
     if (top_block.simulate)
     {
         handler(error::success);
@@ -295,6 +726,7 @@ void block_organizer::handle_reorganized(const code& ec,
     block_pool_.remove(branch->blocks());
     block_pool_.prune(branch->top_height());
     block_pool_.add(outgoing);
+    parked_.prune(branch->top_height());
 
     // v3 reorg block order is reverse of v2, branch.back() is the new top.
     notify(branch->height(), branch->blocks(), outgoing);
@@ -302,6 +734,49 @@ void block_organizer::handle_reorganized(const code& ec,
     handler(error::success);
 }
 
+// Parked sub-sequence.
+//-----------------------------------------------------------------------------
+// A block without the work to reorganize is pooled on its header checks alone
+// (proof of work is checked with the body). Its body is validated only once a
+// branch through it has the work to reorganize.
+
+// private
+bool block_organizer::get_sufficient_work(bool& out_sufficient,
+    branch::const_ptr branch)
+{
+    uint256_t threshold;
+    const auto work = branch->work();
+    const auto first_height = branch->height() + 1u;
+
+    // The chain query will stop if it reaches work level.
+    if (!fast_chain_.get_branch_work(threshold, work, first_height))
+        return false;
+
+    out_sufficient = work > threshold;
+    return true;
+}
+
+// private
+code block_organizer::park(branch::const_ptr branch)
+{
+    const auto ec = validator_.accept_header(branch);
+
+    if (ec)
+        return ec;
+
+    const auto block = branch->top();
+    const auto height = branch->top_height();
+
+    // Reorganization requires these of each incoming block.
+    auto& header = block->header().validation;
+    header.median_time_past = block->validation.state->median_time_past();
+    header.height = height;
+
+    parked_.park(block->hash(), height);
+    block_pool_.add(block);
+    return error::insufficient_work;
+}
+
 // Subscription.
 //-----------------------------------------------------------------------------
 
@@ -333,6 +808,12 @@ void block_organizer::filter(get_data_ptr message) const
     block_pool_.filter(message);
 }
 
+void block_organizer::filter(get_data_ptr message,
+    const block_pool::hash_predicate& exists) const
+{
+    block_pool_.filter(message, exists);
+}
+
 // Utility.
 //-----------------------------------------------------------------------------
 
@@ -130,93 +130,98 @@ void block_pool::remove(block_const_ptr_list_const_ptr accepted_blocks)
     }
 }
 
-// protected
-void block_pool::prune(const hash_list& hashes, size_t minimum_height)
+// Roots are ordered by height in the right view, so expired roots are a
+// range query. Their subtrees are then spanned once, deleting expired nodes
+// and replanting the first unexpired node of each path as a root in place.
+void block_pool::prune(size_t top_height)
 {
-    hash_list child_hashes;
-    auto saver = [&](const hash_digest& hash){ child_hashes.push_back(hash); };
+    const auto minimum_height = floor_subtract(top_height, maximum_depth_);
+
+    // Roots have non-zero height, so none can be below one.
+    if (minimum_height <= 1u)
+        return;
+
     auto& left = blocks_.left;
+    const auto& right = blocks_.right;
+    hash_list expired;
+
+    // Get outside of the table iterator before deleting.
+    for (auto it = right.upper_bound(0); it != right.end() &&
+        it->first < minimum_height; ++it)
+        expired.push_back(it->second.hash());
+
+    if (expired.empty())
+        return;
 
-    for (auto& hash: hashes)
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    while (!expired.empty())
     {
-        const auto it = left.find(block_entry{ hash });
+        const auto it = left.find(block_entry{ expired.back() });
+        expired.pop_back();
         BITCOIN_ASSERT(it != left.end());
 
-        const auto height = it->first.block()->header().validation.height;
-
-        // Delete all roots and expired non-roots and recurse their children.
-        if (it->second != 0 || height < minimum_height)
+        for (const auto& child: it->first.children())
         {
-            // delete
-            const auto& children = it->first.children();
-            std::for_each(children.begin(), children.end(), saver);
+            const auto node = left.find(block_entry{ child });
 
-            ///////////////////////////////////////////////////////////////////
-            // Critical Section
-            unique_lock lock(mutex_);
-            left.erase(it);
-            ///////////////////////////////////////////////////////////////////
+            if (node == left.end())
+                continue;
 
-            continue;
-        }
+            const auto height = node->first.block()->header().validation.height;
 
-        // Copy the entry so that it can be deleted and replanted with height.
-        const auto copy = it->first;
+            if (height < minimum_height)
+                expired.push_back(child);
+            else
+                left.replace_data(node, height);
+        }
 
-        // Critical Section
-        ///////////////////////////////////////////////////////////////////////
-        unique_lock lock(mutex_);
         left.erase(it);
-        blocks_.insert({ copy, height });
-        ///////////////////////////////////////////////////////////////////////
     }
-
-    // Recurse the children to span the tree.
-    if (!child_hashes.empty())
-        prune(child_hashes, minimum_height);
+    ///////////////////////////////////////////////////////////////////////////
 }
 
-void block_pool::prune(size_t top_height)
+void block_pool::filter(get_data_ptr message) const
 {
-    hash_list hashes;
-    const auto minimum_height = floor_subtract(top_height, maximum_depth_);
-
-    // TODO: not using table sort here, should stop iterating once above min.
-    // Iterate over all root nodes with insufficient height.
-    for (auto it: blocks_.right)
-        if (it.first != 0 && it.first < minimum_height)
-            hashes.push_back(it.second.hash());
-
-    // Get outside of the hash table iterator before deleting.
-    if (!hashes.empty())
-        prune(hashes, minimum_height);
+    filter(message, nullptr);
 }
 
-void block_pool::filter(get_data_ptr message) const
+void block_pool::filter(get_data_ptr message,
+    const hash_predicate& exists) const
 {
     auto& inventories = message->inventories();
     const auto& left = blocks_.left;
 
-    for (auto it = inventories.begin(); it != inventories.end();)
+    const auto pooled = [&](const bc::message::inventory_vector& inventory)
     {
-        if (!it->is_block_type())
-        {
-            ++it;
-            continue;
-        }
+        return inventory.is_block_type() &&
+            left.find(block_entry{ inventory.hash() }) != left.end();
+    };
 
-        const block_entry entry{ it->hash() };
+    const auto stored = [&](const bc::message::inventory_vector& inventory)
+    {
+        return inventory.is_block_type() && exists(inventory.hash());
+    };
 
-        ///////////////////////////////////////////////////////////////////////
-        // Critical Section
-        mutex_.lock_shared();
-        const auto found = (left.find(entry) != left.end());
-        mutex_.unlock_shared();
-        ///////////////////////////////////////////////////////////////////////
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        shared_lock lock(mutex_);
 
-        // TODO: optimize (prevent repeating vector moves).
-        it = found ? inventories.erase(it) : it + 1;
+        // Compact in place, linear in the number of inventories.
+        inventories.erase(std::remove_if(inventories.begin(),
+            inventories.end(), pooled), inventories.end());
     }
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!exists)
+        return;
+
+    // The store is queried outside of the critical section.
+    inventories.erase(std::remove_if(inventories.begin(), inventories.end(),
+        stored), inventories.end());
 }
 
 // protected
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
@@ -174,6 +175,36 @@ uint256_t branch::work() const
 ////    tx.validation.duplicate = count > 1u;
 ////}
 
+// private
+void branch::index_transactions() const
+{
+    const auto& blocks = *blocks_;
+
+    for (size_t index = 0; index < blocks.size(); ++index)
+    {
+        const auto& txs = blocks[index]->transactions();
+
+        // Reverse so that the first occurrence in a block is retained.
+        for (auto tx = txs.size(); tx > 0; --tx)
+            transactions_[txs[tx - 1u].hash()] = { index, tx - 1u };
+    }
+}
+
+// private
+void branch::index_spends() const
+{
+    // The top block is excluded, see populate_spent.
+    for (auto block = blocks_->begin(); block + 1 < blocks_->end(); ++block)
+    {
+        const auto& txs = (*block)->transactions();
+        BITCOIN_ASSERT_MSG(!txs.empty(), "empty block in branch");
+
+        for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx)
+            for (const auto& input: tx->inputs())
+                spends_.insert(input.previous_output());
+    }
+}
+
 // TODO: convert to a direct block pool query when the branch goes away.
 void branch::populate_spent(const output_point& outpoint) const
 {
@@ -192,26 +223,9 @@ void branch::populate_spent(const output_point& outpoint) const
     }
 
     // TODO: use hash table storage of block's inputs for block pool entries.
-    const auto blocks = [&outpoint](block_const_ptr block)
-    {
-        const auto transactions = [&outpoint](const transaction& tx)
-        {
-            const auto prevout_match = [&outpoint](const input& input)
-            {
-                return input.previous_output() == outpoint;
-            };
-
-            const auto& ins = tx.inputs();
-            return std::any_of(ins.begin(), ins.end(), prevout_match);
-        };
-
-        const auto& txs = block->transactions();
-        BITCOIN_ASSERT_MSG(!txs.empty(), "empty block in branch");
-        return std::any_of(txs.begin() + 1, txs.end(), transactions);
-    };
+    std::call_once(spends_indexed_, &branch::index_spends, this);
 
-    auto spent = std::any_of(blocks_->begin(), blocks_->end() - 1, blocks);
-    prevout.spent = spent;
+    prevout.spent = spends_.find(outpoint) != spends_.end();
     prevout.confirmed = prevout.spent;
 }
 
@@ -230,32 +244,25 @@ void branch::populate_prevout(const output_point& outpoint) const
     if (outpoint.is_null())
         return;
 
+    // The index retains the last occurrence because of BIP30.
+    std::call_once(transactions_indexed_, &branch::index_transactions, this);
+    const auto found = transactions_.find(outpoint.hash());
+
+    if (found == transactions_.end())
+        return;
+
     // Get the input's previous output and its validation metadata.
-    const auto count = size();
-    const auto& blocks = *blocks_;
+    const auto index = found->second.block;
+    const auto& tx = (*blocks_)[index]->transactions()[
+        found->second.transaction];
 
-    // Reverse iterate because of BIP30.
-    for (size_t forward = 0; forward < count; ++forward)
-    {
-        const size_t index = count - forward - 1u;
-        const auto& txs = blocks[index]->transactions();
-        prevout.coinbase = true;
-
-        for (const auto& tx: txs)
-        {
-            // Found the prevout at or below the indexed block.
-            if (outpoint.hash() == tx.hash() &&
-                outpoint.index() < tx.outputs().size())
-            {
-                prevout.height = height_at(index);
-                prevout.median_time_past = median_time_past_at(index);
-                prevout.cache = tx.outputs()[outpoint.index()];
-                return;
-            }
-
-            prevout.coinbase = false;
-        }
-    }
+    if (outpoint.index() >= tx.outputs().size())
+        return;
+
+    prevout.coinbase = found->second.transaction == 0;
+    prevout.height = height_at(index);
+    prevout.median_time_past = median_time_past_at(index);
+    prevout.cache = tx.outputs()[outpoint.index()];
 }
 
 // TODO: absorb into the main chain for speed and code consolidation.
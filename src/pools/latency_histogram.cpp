@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/latency_histogram.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace libbitcoin {
+namespace blockchain {
+
+latency_histogram::latency_histogram()
+  : count_(0), total_(0), maximum_(0)
+{
+    for (auto& bucket: buckets_)
+        bucket.store(0);
+}
+
+size_t latency_histogram::bucket(duration elapsed)
+{
+    auto value = static_cast<uint64_t>(std::max(elapsed.count(),
+        duration::rep(0)));
+
+    size_t index = 0;
+
+    for (; value != 0 && index < bucket_count - 1u; value >>= 1)
+        ++index;
+
+    return index;
+}
+
+void latency_histogram::record(duration elapsed)
+{
+    const auto value = static_cast<uint64_t>(std::max(elapsed.count(),
+        duration::rep(0)));
+
+    ++buckets_[bucket(elapsed)];
+    ++count_;
+    total_ += value;
+
+    auto maximum = maximum_.load();
+    while (value > maximum && !maximum_.compare_exchange_weak(maximum, value));
+}
+
+// Counters are read independently, so totals may be slightly inconsistent.
+latency_histogram::summary latency_histogram::summarize() const
+{
+    summary out;
+    out.count = count_.load();
+    out.total = duration(total_.load());
+    out.maximum = duration(maximum_.load());
+
+    for (size_t index = 0; index < bucket_count; ++index)
+        out.buckets[index] = buckets_[index].load();
+
+    return out;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
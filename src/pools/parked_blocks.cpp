@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/parked_blocks.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/pools/branch.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+parked_blocks::parked_blocks(size_t maximum_depth)
+  : maximum_depth_(maximum_depth)
+{
+}
+
+size_t parked_blocks::size() const
+{
+    return parked_.size();
+}
+
+void parked_blocks::park(const hash_digest& hash, size_t height)
+{
+    parked_[hash] = { height, error::success };
+}
+
+bool parked_blocks::is_parked(const hash_digest& hash) const
+{
+    return parked_.find(hash) != parked_.end();
+}
+
+void parked_blocks::fail(const hash_digest& hash, const code& ec)
+{
+    if (!is_retained(ec))
+        return;
+
+    const auto it = parked_.find(hash);
+
+    if (it != parked_.end())
+        it->second.error = ec;
+}
+
+void parked_blocks::unpark(const hash_digest& hash)
+{
+    parked_.erase(hash);
+}
+
+// Parked blocks below the pool depth have been pruned from the pool.
+void parked_blocks::prune(size_t top_height)
+{
+    const auto minimum_height = floor_subtract(top_height, maximum_depth_);
+
+    for (auto it = parked_.begin(); it != parked_.end();)
+    {
+        if (it->second.height < minimum_height)
+            it = parked_.erase(it);
+        else
+            ++it;
+    }
+}
+
+code parked_blocks::get_error(branch::const_ptr branch) const
+{
+    const auto& blocks = *branch->blocks();
+
+    // The top block is not pooled.
+    for (size_t index = 0; index + 1u < blocks.size(); ++index)
+    {
+        const auto it = parked_.find(blocks[index]->hash());
+
+        if (it != parked_.end() && it->second.error)
+            return it->second.error;
+    }
+
+    return error::success;
+}
+
+branch::ptr parked_blocks::get_prefix(branch::const_ptr branch, size_t index)
+{
+    const auto& blocks = *branch->blocks();
+    const auto count = std::min(index + 1u, blocks.size());
+    const auto prefix = std::make_shared<blockchain::branch>(branch->height());
+
+    for (auto block = count; block > 0; --block)
+        prefix->push_front(blocks[block - 1u]);
+
+    return prefix;
+}
+
+// Stop and store failures do not invalidate the block, a later branch
+// through it must be able to validate it again.
+bool parked_blocks::is_retained(const code& ec)
+{
+    return ec &&
+        ec != error::service_stopped &&
+        ec != error::not_found &&
+        ec != error::operation_failed &&
+        ec != error::operation_failed_18 &&
+        ec != error::operation_failed_19 &&
+        ec != error::operation_failed_21;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
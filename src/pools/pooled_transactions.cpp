@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/pooled_transactions.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+pooled_transactions::pooled_transactions(size_t capacity)
+  : shard_capacity_(capacity == 0 ? 0 : (capacity - 1) / shard_count + 1),
+    epoch_(0)
+{
+}
+
+pooled_transactions::shard& pooled_transactions::select(
+    const hash_digest& hash) const
+{
+    return shards_[hash.front() % shard_count];
+}
+
+bool pooled_transactions::find(uint32_t& out_forks, bool& out_fresh,
+    const hash_digest& hash) const
+{
+    if (shard_capacity_ == 0)
+        return false;
+
+    auto& bucket = select(hash);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(bucket.mutex);
+    const auto it = bucket.map.find(hash);
+
+    if (it == bucket.map.end())
+        return false;
+
+    out_forks = it->second.forks;
+    out_fresh = (it->second.epoch == epoch_);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void pooled_transactions::add(const hash_digest& hash, uint32_t forks)
+{
+    if (shard_capacity_ == 0)
+        return;
+
+    auto& bucket = select(hash);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(bucket.mutex);
+
+    const auto sequence = ++bucket.sequence;
+    const auto it = bucket.map.find(hash);
+
+    if (it != bucket.map.end())
+    {
+        it->second = { forks, sequence, epoch_ };
+    }
+    else
+    {
+        if (bucket.map.size() >= shard_capacity_)
+            evict(bucket);
+
+        bucket.map.emplace(hash, entry{ forks, sequence, epoch_ });
+    }
+
+    bucket.fifo.emplace_back(hash, sequence);
+
+    // Removed and refreshed entries leave skipped positions behind.
+    if (bucket.fifo.size() > 2u * shard_capacity_)
+        compact(bucket);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Call only under the shard's unique lock.
+void pooled_transactions::evict(shard& bucket)
+{
+    while (!bucket.fifo.empty())
+    {
+        const auto oldest = bucket.fifo.front();
+        bucket.fifo.pop_front();
+        const auto it = bucket.map.find(oldest.first);
+
+        if (it != bucket.map.end() && it->second.sequence == oldest.second)
+        {
+            bucket.map.erase(it);
+            return;
+        }
+    }
+}
+
+// private
+// Call only under the shard's unique lock.
+void pooled_transactions::compact(shard& bucket)
+{
+    order current;
+
+    for (const auto& position: bucket.fifo)
+    {
+        const auto it = bucket.map.find(position.first);
+
+        if (it != bucket.map.end() && it->second.sequence == position.second)
+            current.push_back(position);
+    }
+
+    bucket.fifo.swap(current);
+}
+
+void pooled_transactions::remove(const hash_digest& hash)
+{
+    if (shard_capacity_ == 0)
+        return;
+
+    auto& bucket = select(hash);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(bucket.mutex);
+    bucket.map.erase(hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void pooled_transactions::invalidate()
+{
+    ++epoch_;
+}
+
+size_t pooled_transactions::size() const
+{
+    size_t count = 0;
+
+    for (auto& bucket: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(bucket.mutex);
+        count += bucket.map.size();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return count;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/reject_filter.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// Zero is reserved to mark an empty slot.
+static const uint64_t empty_key = 0;
+
+reject_filter::reject_filter(size_t capacity)
+  : salt_(pseudo_random()),
+    entries_(capacity, { empty_key, error::success })
+{
+}
+
+// The salt prevents an attacker from targeting slots for eviction.
+uint64_t reject_filter::key(const hash_digest& hash) const
+{
+    const auto value = from_little_endian_unsafe<uint64_t>(hash.begin());
+    const auto salted = value ^ salt_;
+    return salted == empty_key ? 1 : salted;
+}
+
+code reject_filter::find(const hash_digest& hash) const
+{
+    if (entries_.empty())
+        return error::success;
+
+    const auto value = key(hash);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    const auto& slot = entries_[value % entries_.size()];
+    return slot.key == value ? slot.reason : error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void reject_filter::store(const hash_digest& hash, const code& reason)
+{
+    if (entries_.empty() || !is_cacheable(reason))
+        return;
+
+    const auto value = key(hash);
+    const auto cause = static_cast<error::error_code_t>(reason.value());
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    entries_[value % entries_.size()] = { value, cause };
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void reject_filter::clear()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    std::fill(entries_.begin(), entries_.end(),
+        entry{ empty_key, error::success });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Missing prevouts, double spends and stop codes may change with the pool.
+bool reject_filter::is_cacheable(const code& reason)
+{
+    return reason == error::insufficient_fee ||
+        reason == error::dusty_transaction ||
+        reason == error::stack_false ||
+        reason == error::invalid_script ||
+        reason == error::invalid_signature_encoding;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -19,11 +19,16 @@
 #include <bitcoin/blockchain/pools/transaction_organizer.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <future>
+#include <iterator>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
@@ -41,14 +46,17 @@ using namespace std::placeholders;
 // TODO: create priority pool at blockchain level and use in both organizers. 
 transaction_organizer::transaction_organizer(prioritized_mutex& mutex,
     dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain,
-    const settings& settings)
+    script_cache& cache, const settings& settings)
   : fast_chain_(chain),
     mutex_(mutex),
     stopped_(true),
     settings_(settings),
     dispatch_(dispatch),
+    network_dispatch_(thread_pool, NAME "_network"),
     transaction_pool_(settings),
-    validator_(dispatch, fast_chain_, settings),
+    validator_(dispatch, fast_chain_, cache, settings),
+    rejects_(settings.reject_filter_capacity),
+    admission_(settings.admission_queue_capacity, dispatch.size()),
     subscriber_(std::make_shared<transaction_subscriber>(thread_pool, NAME))
 {
 }
@@ -75,9 +83,15 @@ bool transaction_organizer::start()
 bool transaction_organizer::stop()
 {
     validator_.stop();
+    stopped_ = true;
+    admission_.stop();
+
+    // Wait on validations in flight, as these depend on the priority pool.
+    pipeline_mutex_.lock();
+    pipeline_mutex_.unlock();
+
     subscriber_->stop();
     subscriber_->invoke(error::service_stopped, {});
-    stopped_ = true;
     return true;
 }
 
@@ -86,13 +100,64 @@ bool transaction_organizer::stop()
 
 // This is called from block_chain::transaction_validate.
 void transaction_organizer::transaction_validate(transaction_const_ptr tx, result_handler handler) const {
-    auto const check_handler = std::bind(&transaction_organizer::validate_handle_check, this, _1, tx, handler);
+    // Repeat submissions of a recently rejected tx cost one probe.
+    auto const rejected = rejects_.find(reject_key(tx));
+
+    if (rejected) {
+        handler(rejected);
+        return;
+    }
+
+    auto const validated_handler = std::bind(&transaction_organizer::handle_validated, this, _1, tx, handler);
     // Checks that are independent of chain state.
-    validator_.check(tx, check_handler);
+    validate_handle_check(check(tx), tx, false, validated_handler);
 }
 
 // private
-void transaction_organizer::validate_handle_check(code const& ec, transaction_const_ptr tx, result_handler handler) const {
+void transaction_organizer::handle_validated(code const& ec, transaction_const_ptr tx, result_handler handler) const {
+    // Only reasons that do not depend on pool state are recorded.
+    rejects_.store(reject_key(tx), ec);
+    handler(ec);
+}
+
+// private static
+// Script failures may be malleated by witness, so key on the witness hash.
+hash_digest transaction_organizer::reject_key(transaction_const_ptr tx) {
+#ifdef BITPRIM_CURRENCY_BCH
+    return tx->hash();
+#else
+    return tx->hash(true);
+#endif
+}
+
+transaction_organizer::admission_statistics
+transaction_organizer::admission_stats() const {
+    return admission_.stats();
+}
+
+latency_histogram::summary transaction_organizer::latency(stage step) const {
+    return latencies_[static_cast<size_t>(step)].summarize();
+}
+
+// private
+// Returns the end time, which is the start of any subsequent stage.
+asio::time_point transaction_organizer::record(stage step,
+    asio::time_point start) const {
+    const auto end = asio::steady_clock::now();
+    const auto elapsed = std::chrono::duration_cast<
+        latency_histogram::duration>(end - start);
+
+    latencies_[static_cast<size_t>(step)].record(elapsed);
+    return end;
+}
+
+// Clear recorded rejections, as policy and forks may change with the tip.
+void transaction_organizer::reset_rejects() {
+    rejects_.clear();
+}
+
+// private
+void transaction_organizer::validate_handle_check(code const& ec, transaction_const_ptr tx, bool repool, result_handler handler) const {
     if (stopped()) {
         handler(error::service_stopped);
         return;
@@ -103,13 +168,17 @@ void transaction_organizer::validate_handle_check(code const& ec, transaction_co
         return;
     }
 
-    auto const accept_handler = std::bind(&transaction_organizer::validate_handle_accept, this, _1, tx, handler);
+    // Stages are timed as in the single organize sequence.
+    auto const start = asio::steady_clock::now();
+    auto const accept_handler = std::bind(&transaction_organizer::validate_handle_accept, this, _1, tx, start, handler);
     // Checks that are dependent on chain state and prevouts.
-    validator_.accept(tx, accept_handler);
+    validator_.populate(tx, repool, accept_handler);
 }
 
 // private
-void transaction_organizer::validate_handle_accept(code const& ec, transaction_const_ptr tx, result_handler handler) const {
+void transaction_organizer::validate_handle_accept(code const& ec, transaction_const_ptr tx, asio::time_point start, result_handler handler) const {
+    start = record(stage::populate, start);
+
     if (stopped()) {
         handler(error::service_stopped);
         return;
@@ -120,24 +189,41 @@ void transaction_organizer::validate_handle_accept(code const& ec, transaction_c
         return;
     }
 
-    if (tx->fees() < price(tx)) {
-        handler(error::insufficient_fee);
-        return;
-    }
+    // Run contextual tx checks.
+    auto accepted = tx->accept();
+
+    if (!accepted)
+        accepted = check_policy(tx);
+
+    start = record(stage::accept, start);
 
-    if (tx->is_dusty(settings_.minimum_output_satoshis)) {
-        handler(error::dusty_transaction);
+    if (accepted) {
+        handler(accepted);
         return;
     }
 
-    auto const connect_handler = std::bind(&transaction_organizer::validate_handle_connect, this, _1, tx, handler);
+    auto const connect_handler = std::bind(&transaction_organizer::validate_handle_connect, this, _1, tx, start, handler);
 
     // Checks that include script validation.
     validator_.connect(tx, connect_handler);
 }
 
 // private
-void transaction_organizer::validate_handle_connect(code const& ec, transaction_const_ptr tx, result_handler handler) const {
+// Checks that require the populated fee.
+code transaction_organizer::check_policy(transaction_const_ptr tx) const {
+    if (tx->fees() < price(tx))
+        return error::insufficient_fee;
+
+    if (tx->is_dusty(settings_.minimum_output_satoshis))
+        return error::dusty_transaction;
+
+    return error::success;
+}
+
+// private
+void transaction_organizer::validate_handle_connect(code const& ec, transaction_const_ptr tx, asio::time_point start, result_handler handler) const {
+    record(stage::connect, start);
+
     if (stopped()) {
         handler(error::service_stopped);
         return;
@@ -158,166 +244,583 @@ void transaction_organizer::validate_handle_connect(code const& ec, transaction_
 //-----------------------------------------------------------------------------
 
 // This is called from block_chain::organize.
+// Validation is read-only against the chain, so independent transactions are
+// validated concurrently and only the commit is serialized.
 void transaction_organizer::organize(transaction_const_ptr tx,
     result_handler handler)
 {
-    // Critical Section
+    const auto rejected = rejects_.find(reject_key(tx));
+
+    if (rejected)
+    {
+        handler(rejected);
+        return;
+    }
+
+    // Critical Section (pipeline)
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_low_priority();
+    pipeline_mutex_.lock_shared();
 
     if (stopped())
     {
-        mutex_.unlock_low_priority();
+        pipeline_mutex_.unlock_shared();
         handler(error::service_stopped);
         return;
     }
 
-    // Reset the reusable promise.
-    resume_ = std::promise<code>();
+    // Checks that are independent of chain state.
+    auto ec = check(tx);
 
-    const result_handler complete =
-        std::bind(&transaction_organizer::signal_completion,
-            this, _1);
+    // Checks of chain state and fee policy, which populate prevouts.
+    if (!ec)
+        ec = accept(tx);
 
-    const auto check_handler =
-        std::bind(&transaction_organizer::handle_check,
-            this, _1, tx, complete);
+    auto admitted = false;
 
-    // Checks that are independent of chain state.
-    validator_.check(tx, check_handler);
+    // Script validation is admitted in order of fee rate, waiting here.
+    // A shed tx is not script validated.
+    if (!ec)
+    {
+        const auto start = asio::steady_clock::now();
+        ec = admission_.enter(admission_priority(tx));
+        record(stage::admission, start);
+        admitted = !ec;
+    }
+
+    if (!ec)
+    {
+        const auto start = asio::steady_clock::now();
+        ec = connect(tx);
+        record(stage::connect, start);
+    }
+
+    if (admitted)
+        admission_.leave();
+
+    pipeline_mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Simulated transactions share only the pipeline and are never committed.
+    if (!ec && !tx->validation.simulate)
+        ec = commit(tx);
+
+    // The tx may have been revalidated against a new tip at commit.
+    rejects_.store(reject_key(tx), ec);
+
+    // Invoke caller handler outside of critical section.
+    handler(ec);
+}
+
+// private
+code transaction_organizer::check(transaction_const_ptr tx) const
+{
+    const auto start = asio::steady_clock::now();
+
+    code ec;
+    validator_.check(tx, [&ec](const code& checked) { ec = checked; });
+    record(stage::check, start);
+    return ec;
+}
+
+// private
+// Blocks the calling thread, which must not be a priority thread.
+code transaction_organizer::accept(transaction_const_ptr tx) const
+{
+    auto start = asio::steady_clock::now();
+    code ec;
+
+    std::promise<code> populated;
+    validator_.populate(tx,
+        [&populated](const code& ec) { populated.set_value(ec); });
 
     // Wait on completion signal.
     // This is necessary in order to continue on a non-priority thread.
     // If we do not wait on the original thread there may be none left.
-    auto ec = resume_.get_future().get();
+    ec = populated.get_future().get();
+    start = record(stage::populate, start);
+
+    if (ec)
+        return ec;
+
+    if (stopped())
+        return error::service_stopped;
+
+    // Run contextual tx checks.
+    if (!(ec = tx->accept()))
+        ec = check_policy(tx);
+
+    record(stage::accept, start);
+    return ec;
+}
+
+// private
+// Blocks the calling thread, which must not be a priority thread.
+code transaction_organizer::connect(transaction_const_ptr tx) const
+{
+    std::promise<code> connected;
+    validator_.connect(tx,
+        [&connected](const code& ec) { connected.set_value(ec); });
+
+    const auto ec = connected.get_future().get();
+    return stopped() ? error::service_stopped : ec;
+}
+
+// Satoshis per kilobyte, available once prevouts are populated.
+uint64_t transaction_organizer::admission_priority(transaction_const_ptr tx)
+{
+    const auto size = tx->serialized_size(true);
+    return size == 0 ? 0 : tx->fees() * 1000u / size;
+}
+
+// private
+code transaction_organizer::commit(transaction_const_ptr tx)
+{
+    const auto start = asio::steady_clock::now();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_low_priority();
+    record(stage::lock_wait, start);
+
+    if (stopped())
+    {
+        mutex_.unlock_low_priority();
+        return error::service_stopped;
+    }
+
+    refresh_commit_state();
+    code ec;
+
+    // A block was organized during validation, so prevouts may have changed.
+    if (tx->validation.state != commit_state_)
+        ec = revalidate(tx);
+
+    // Another tx spending a common outpoint was committed during validation.
+    else if (is_conflicted(tx))
+        ec = error::double_spend;
+
+    if (!ec)
+        ec = push_transaction(tx);
 
     mutex_.unlock_low_priority();
     ///////////////////////////////////////////////////////////////////////////
 
-    // Invoke caller handler outside of critical section.
-    handler(ec);
+    return ec;
 }
 
 // private
-void transaction_organizer::signal_completion(const code& ec)
+// Call only from inside the critical section.
+code transaction_organizer::revalidate(transaction_const_ptr tx) const
 {
-    // This must be protected so that it is properly cleared.
-    // Signal completion, which results in original handler invoke with code.
-    resume_.set_value(ec);
+    std::promise<code> validated;
+    const result_handler complete =
+        [&validated](const code& ec) { validated.set_value(ec); };
+
+    // The context free checks are not repeated.
+    validate_handle_check(error::success, tx, false, complete);
+    return validated.get_future().get();
 }
 
-// Verify sub-sequence.
+// private
+// Call only from inside the critical section.
+void transaction_organizer::refresh_commit_state()
+{
+    const auto state = fast_chain_.chain_state();
+
+    if (state == commit_state_)
+        return;
+
+    commit_state_ = state;
+
+    // Unconfirmed spends are not marked in the store (see populate_base), so
+    // spends of txs that remain pooled are retained across states. Spends of
+    // confirmed txs are marked in the store, so are dropped, as are those of
+    // txs no longer stored. Each spender is queried once.
+    std::unordered_map<hash_digest, bool> pooled;
+
+    for (auto it = committed_spends_.begin(); it != committed_spends_.end();)
+    {
+        auto spender = pooled.find(it->second);
+
+        if (spender == pooled.end())
+            spender = pooled.emplace(it->second, is_pooled(it->second)).first;
+
+        it = spender->second ? std::next(it) : committed_spends_.erase(it);
+    }
+}
+
+// private
+// Call only from inside the critical section.
+bool transaction_organizer::is_pooled(const hash_digest& hash) const
+{
+    size_t height;
+    size_t position;
+    return fast_chain_.get_transaction_position(height, position, hash,
+        false) && position == database::transaction_database::unconfirmed;
+}
+
+// private
+// Call only from inside the critical section.
+bool transaction_organizer::is_conflicted(transaction_const_ptr tx) const
+{
+    const auto& inputs = tx->inputs();
+    const auto& hash = tx->hash();
+
+    // A repooled tx may find its own spends, committed before it confirmed.
+    const auto spent = [this, &hash](const chain::input& input)
+    {
+        const chain::point& prevout = input.previous_output();
+        const auto spend = committed_spends_.find(prevout);
+        return spend != committed_spends_.end() && spend->second != hash;
+    };
+
+    return std::any_of(inputs.begin(), inputs.end(), spent);
+}
+
+// Batch organize sequence.
 //-----------------------------------------------------------------------------
 
+// This is called from block_chain::organize.
+// Results are returned in the order of the given transactions.
+void transaction_organizer::organize(transaction_const_ptr_list txs,
+    batch_handler handler)
+{
+    organize(txs, false, handler);
+}
+
 // private
-void transaction_organizer::handle_check(const code& ec,
-    transaction_const_ptr tx, result_handler handler)
+// Txs of disconnected blocks are repooled, which are stored as unconfirmed.
+void transaction_organizer::organize(transaction_const_ptr_list txs,
+    bool repool, batch_handler handler)
 {
+    // Critical Section (pipeline)
+    ///////////////////////////////////////////////////////////////////////////
+    pipeline_mutex_.lock_shared();
+
     if (stopped())
     {
-        handler(error::service_stopped);
+        pipeline_mutex_.unlock_shared();
+        handler(error::service_stopped, {});
         return;
     }
 
-    if (ec)
+    // Checks that are independent of chain state, outside of critical section.
+    auto results = check_batch(txs);
+
+    // Parents precede children across levels, txs within a level are disjoint.
+    const auto levels = sort_dependencies(txs);
+
+    // Stop waits on the pipeline while holding the validation lock, so the
+    // pipeline is not held while waiting on that lock. Once it is obtained
+    // stop cannot be in progress, and a completed stop is detected below.
+    pipeline_mutex_.unlock_shared();
+
+    const auto start = asio::steady_clock::now();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_low_priority();
+    record(stage::lock_wait, start);
+    pipeline_mutex_.lock_shared();
+
+    // Spends committed by single txs under the current state conflict.
+    refresh_commit_state();
+
+    for (const auto& level: levels)
     {
-        handler(ec);
-        return;
+        if (stopped())
+        {
+            pipeline_mutex_.unlock_shared();
+            mutex_.unlock_low_priority();
+            handler(error::service_stopped, {});
+            return;
+        }
+
+        // Populate and verify scripts of the level in parallel.
+        accept_level(txs, level, repool, results);
+
+        for (const auto index: level)
+        {
+            const auto tx = txs[index];
+            auto& ec = results[index];
+
+            // Children of rejected txs fail here on missing prevouts.
+            if (ec || tx->validation.simulate)
+                continue;
+
+            // Txs of a level are validated independently and may spend a
+            // common outpoint, as may a tx committed by the single path.
+            if (is_conflicted(tx))
+            {
+                ec = error::double_spend;
+                rejects_.store(reject_key(tx), ec);
+                continue;
+            }
+
+            // The pushed tx records its spends for subsequent conflicts.
+            if ((ec = push_transaction(tx)))
+            {
+                pipeline_mutex_.unlock_shared();
+                mutex_.unlock_low_priority();
+                handler(ec, results);
+                return;
+            }
+        }
     }
 
-    const auto accept_handler =
-        std::bind(&transaction_organizer::handle_accept,
-            this, _1, tx, handler);
+    pipeline_mutex_.unlock_shared();
+    mutex_.unlock_low_priority();
+    ///////////////////////////////////////////////////////////////////////////
 
-    // Checks that are dependent on chain state and prevouts.
-    validator_.accept(tx, accept_handler);
+    // Invoke caller handler outside of critical section.
+    handler(error::success, results);
 }
 
 // private
-void transaction_organizer::handle_accept(const code& ec,
-    transaction_const_ptr tx, result_handler handler)
+transaction_organizer::code_list transaction_organizer::check_batch(
+    const transaction_const_ptr_list& txs) const
 {
-    if (stopped())
+    code_list results(txs.size(), error::success);
+
+    if (txs.empty())
+        return results;
+
+    const auto buckets = std::min(dispatch_.size(), txs.size());
+    BITCOIN_ASSERT(buckets != 0);
+
+    std::promise<code> complete;
+    const auto join_handler = synchronize(
+        [&complete](const code& ec) { complete.set_value(ec); },
+        buckets, NAME "_check", synchronizer_terminate::on_count);
+
+    for (size_t bucket = 0; bucket < buckets; ++bucket)
+        dispatch_.concurrent(&transaction_organizer::check_transactions,
+            this, std::cref(txs), bucket, buckets, std::ref(results),
+            join_handler);
+
+    complete.get_future().wait();
+    return results;
+}
+
+// private
+void transaction_organizer::check_transactions(
+    const transaction_const_ptr_list& txs, size_t bucket, size_t buckets,
+    code_list& results, result_handler handler) const
+{
+    const auto store = [&results](size_t index)
     {
-        handler(error::service_stopped);
-        return;
-    }
+        return [&results, index](const code& ec) { results[index] = ec; };
+    };
 
-    if (ec)
+    // Each bucket writes only its own result positions.
+    for (auto index = bucket; index < txs.size();
+        index = ceiling_add(index, buckets))
     {
-        handler(ec);
-        return;
+        const auto rejected = rejects_.find(reject_key(txs[index]));
+
+        if (rejected)
+        {
+            results[index] = rejected;
+            continue;
+        }
+
+        const auto start = asio::steady_clock::now();
+        validator_.check(txs[index], store(index));
+        record(stage::check, start);
     }
 
-    if (tx->fees() < price(tx))
+    handler(error::success);
+}
+
+// private
+// Call only from inside the critical section.
+void transaction_organizer::accept_level(const transaction_const_ptr_list& txs,
+    const index_list& level, bool repool, code_list& results) const
+{
+    std::promise<code> complete;
+    const auto join_handler = synchronize(
+        [&complete](const code& ec) { complete.set_value(ec); },
+        level.size(), NAME "_accept", synchronizer_terminate::on_count);
+
+    for (const auto index: level)
     {
-        handler(error::insufficient_fee);
-        return;
+        // Failed checks are counted but not populated.
+        if (results[index])
+        {
+            join_handler(error::success);
+            continue;
+        }
+
+        const auto store = [this, &txs, &results, index, join_handler](
+            const code& ec)
+        {
+            rejects_.store(reject_key(txs[index]), ec);
+            results[index] = ec;
+            join_handler(error::success);
+        };
+
+        // Populates and connects concurrently on the dispatcher.
+        validate_handle_check(error::success, txs[index], repool, store);
     }
 
-    if (tx->is_dusty(settings_.minimum_output_satoshis))
+    complete.get_future().wait();
+}
+
+// private
+// Call only from inside the critical section.
+code transaction_organizer::push_transaction(transaction_const_ptr tx)
+{
+    auto start = asio::steady_clock::now();
+    std::promise<code> pushed;
+    const result_handler complete =
+        [&pushed](const code& ec) { pushed.set_value(ec); };
+
+    //#########################################################################
+    fast_chain_.push(tx, dispatch_, complete);
+    //#########################################################################
+
+    const auto ec = pushed.get_future().get();
+    start = record(stage::push, start);
+
+    if (ec)
     {
-        handler(error::dusty_transaction);
-        return;
+        LOG_FATAL(LOG_BLOCKCHAIN)
+            << "Failure writing transaction to store, is now corrupted: "
+            << ec.message();
+        return ec;
     }
 
-    const auto connect_handler =
-        std::bind(&transaction_organizer::handle_connect,
-            this, _1, tx, handler);
+    refresh_commit_state();
 
-    // Checks that include script validation.
-    validator_.connect(tx, connect_handler);
+    for (const auto& input: tx->inputs())
+        committed_spends_[input.previous_output()] = tx->hash();
+
+    // This gets picked up by node tx-out protocol for announcement to peers.
+    notify(tx);
+    record(stage::notify, start);
+    return error::success;
 }
 
-// private
-void transaction_organizer::handle_connect(const code& ec,
-    transaction_const_ptr tx, result_handler handler)
+// private static
+// Block order is not necessarily topological (CTOR), so sort explicitly.
+transaction_organizer::index_levels transaction_organizer::sort_dependencies(
+    const transaction_const_ptr_list& txs)
 {
-    if (stopped())
+    const auto count = txs.size();
+    std::unordered_map<hash_digest, size_t> positions;
+    positions.reserve(count);
+
+    for (size_t index = 0; index < count; ++index)
+        positions.emplace(txs[index]->hash(), index);
+
+    std::vector<size_t> parents(count, 0);
+    std::vector<index_list> children(count);
+
+    for (size_t index = 0; index < count; ++index)
     {
-        handler(error::service_stopped);
-        return;
+        for (const auto& input: txs[index]->inputs())
+        {
+            const auto it = positions.find(input.previous_output().hash());
+
+            if (it == positions.end() || it->second == index)
+                continue;
+
+            children[it->second].push_back(index);
+            ++parents[index];
+        }
     }
 
-    if (ec)
+    index_list depths(count, 0);
+    index_list ready;
+    index_levels levels;
+
+    for (size_t index = 0; index < count; ++index)
+        if (parents[index] == 0)
+            ready.push_back(index);
+
+    while (!ready.empty())
     {
-        handler(ec);
-        return;
+        const auto index = ready.back();
+        ready.pop_back();
+
+        const auto depth = depths[index];
+
+        if (depth >= levels.size())
+            levels.resize(depth + 1u);
+
+        levels[depth].push_back(index);
+
+        for (const auto child: children[index])
+        {
+            depths[child] = std::max(depths[child], depth + 1u);
+
+            if (--parents[child] == 0)
+                ready.push_back(child);
+        }
     }
 
-    // TODO: create a simulated validation path that does not block others.
-    if (tx->validation.simulate)
+    return levels;
+}
+
+// Repool sequence.
+//-----------------------------------------------------------------------------
+
+// This is called from the block_chain reorganization subscription, which is
+// invoked within the block organizer critical section, so it must not block.
+void transaction_organizer::repool(block_const_ptr_list_const_ptr outgoing,
+    result_handler handler)
+{
+    if (!outgoing || outgoing->empty())
     {
         handler(error::success);
         return;
     }
 
-    const auto pushed_handler =
-        std::bind(&transaction_organizer::handle_pushed,
-            this, _1, tx, handler);
-
-    //#########################################################################
-    fast_chain_.push(tx, dispatch_, pushed_handler);
-    //#########################################################################
+    // Continue on a network thread once the block organizer has released.
+    network_dispatch_.concurrent(&transaction_organizer::do_repool,
+        this, outgoing, handler);
 }
 
 // private
-void transaction_organizer::handle_pushed(const code& ec,
-    transaction_const_ptr tx, result_handler handler)
+void transaction_organizer::do_repool(block_const_ptr_list_const_ptr outgoing,
+    result_handler handler)
 {
-    if (ec)
+    const auto repooled = [outgoing, handler](const code& ec,
+        const code_list& results)
     {
-        LOG_FATAL(LOG_BLOCKCHAIN)
-            << "Failure writing transaction to store, is now corrupted: "
-            << ec.message();
+        const auto rejected = std::count_if(results.begin(), results.end(),
+            [](const code& result) { return bool(result); });
+
+        LOG_DEBUG(LOG_BLOCKCHAIN)
+            << "Repooled (" << results.size() - rejected << ") and rejected ("
+            << rejected << ") transactions of (" << outgoing->size()
+            << ") outgoing blocks.";
+
         handler(ec);
-        return;
-    }
+    };
 
-    // This gets picked up by node tx-out protocol for announcement to peers.
-    notify(tx);
+    organize(to_transactions(outgoing), true, repooled);
+}
 
-    handler(error::success);
+// private static
+// Coinbase transactions cannot be repooled, as they are only valid in block.
+transaction_const_ptr_list transaction_organizer::to_transactions(
+    block_const_ptr_list_const_ptr blocks)
+{
+    transaction_const_ptr_list out;
+
+    for (const auto block: *blocks)
+    {
+        const auto& txs = block->transactions();
+
+        if (txs.empty())
+            continue;
+
+        for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx)
+            out.push_back(std::make_shared<const message::transaction>(*tx));
+    }
+
+    return out;
 }
 
 // Subscription.
@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/populate/duplicate_filter.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// Ten counters per entry with eight functions is under two percent.
+static const size_t counters_per_entry = 10;
+static const size_t counters_per_block = 128;
+
+// Sixteen 4-bit counters per word, eight words in a 64 byte cache line.
+static const size_t counter_bits = 4;
+static const size_t counters_per_word = 16;
+static const uint64_t counter_mask = 0x0f;
+
+// Txids are hash outputs, so their bytes are used directly as the hashes.
+// Bytes [0, 8) select the block and bytes [8, 24) the counters within it.
+static const size_t block_offset = 0;
+static const size_t counters_offset = 8;
+
+duplicate_filter::duplicate_filter(size_t headroom)
+  : headroom_(headroom),
+    blocks_(0),
+    armed_(false)
+{
+}
+
+bool duplicate_filter::enabled() const
+{
+    return headroom_ != 0;
+}
+
+void duplicate_filter::allocate(size_t stored)
+{
+    if (!enabled() || armed())
+        return;
+
+    const auto capacity = ceiling_add(stored, headroom_);
+    blocks_ = (capacity * counters_per_entry - 1) / counters_per_block + 1;
+    std::vector<word>(blocks_ * words_per_block).swap(words_);
+}
+
+void duplicate_filter::arm()
+{
+    if (!words_.empty())
+        armed_.store(true, std::memory_order_release);
+}
+
+bool duplicate_filter::armed() const
+{
+    return armed_.load(std::memory_order_acquire);
+}
+
+size_t duplicate_filter::block_of(const hash_digest& hash) const
+{
+    const auto value = from_little_endian_unsafe<uint64_t>(
+        hash.begin() + block_offset);
+
+    return static_cast<size_t>(value % blocks_);
+}
+
+// private static
+void duplicate_filter::count_up(word& counters, size_t shift)
+{
+    auto expected = counters.load(std::memory_order_relaxed);
+
+    // A saturated counter no longer counts.
+    while (((expected >> shift) & counter_mask) != counter_mask)
+        if (counters.compare_exchange_weak(expected,
+            expected + (uint64_t(1) << shift), std::memory_order_relaxed))
+            return;
+}
+
+// private static
+void duplicate_filter::count_down(word& counters, size_t shift)
+{
+    auto expected = counters.load(std::memory_order_relaxed);
+
+    // A saturated counter may have lost counts, so it remains saturated.
+    while (true)
+    {
+        const auto counter = (expected >> shift) & counter_mask;
+
+        if (counter == 0 || counter == counter_mask)
+            return;
+
+        if (counters.compare_exchange_weak(expected,
+            expected - (uint64_t(1) << shift), std::memory_order_relaxed))
+            return;
+    }
+}
+
+// Each function takes seven bits (one of 128 counters in the block).
+void duplicate_filter::load(const hash_digest& hash)
+{
+    if (words_.empty())
+        return;
+
+    const auto first = block_of(hash) * words_per_block;
+    auto bits = hash.begin() + counters_offset;
+
+    for (size_t function = 0; function < hash_functions; ++function)
+    {
+        const auto position = (bits[0] | (bits[1] << 8)) % counters_per_block;
+        count_up(words_[first + position / counters_per_word],
+            (position % counters_per_word) * counter_bits);
+        bits += 2;
+    }
+}
+
+void duplicate_filter::insert(const hash_digest& hash)
+{
+    if (armed())
+        load(hash);
+}
+
+void duplicate_filter::remove(const hash_digest& hash)
+{
+    if (!armed())
+        return;
+
+    const auto first = block_of(hash) * words_per_block;
+    auto bits = hash.begin() + counters_offset;
+
+    for (size_t function = 0; function < hash_functions; ++function)
+    {
+        const auto position = (bits[0] | (bits[1] << 8)) % counters_per_block;
+        count_down(words_[first + position / counters_per_word],
+            (position % counters_per_word) * counter_bits);
+        bits += 2;
+    }
+}
+
+bool duplicate_filter::may_contain(const hash_digest& hash) const
+{
+    if (!armed())
+        return true;
+
+    const auto first = block_of(hash) * words_per_block;
+    auto bits = hash.begin() + counters_offset;
+
+    for (size_t function = 0; function < hash_functions; ++function)
+    {
+        const auto position = (bits[0] | (bits[1] << 8)) % counters_per_block;
+        const auto shift = (position % counters_per_word) * counter_bits;
+        const auto counters = words_[first + position / counters_per_word].load(
+            std::memory_order_relaxed);
+
+        if (((counters >> shift) & counter_mask) == 0)
+            return false;
+
+        bits += 2;
+    }
+
+    return true;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
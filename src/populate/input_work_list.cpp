@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/populate/input_work_list.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// Each worker takes several chunks so that expensive inputs do not clump.
+static const size_t chunks_per_worker = 16;
+static const size_t maximum_chunk = 64;
+
+input_work_list::input_work_list(const chain::block& block, bool skip_current)
+  : skipped_(0), cursor_(0)
+{
+    const auto& txs = block.transactions();
+    items_.reserve(block.total_inputs(false));
+
+    // Must skip coinbase here as it is already accounted for.
+    for (size_t position = 1; position < txs.size(); ++position)
+    {
+        const auto& tx = txs[position];
+
+        if (skip_current && tx.validation.current)
+        {
+            ++skipped_;
+            continue;
+        }
+
+        const auto inputs = tx.inputs().size();
+
+        for (size_t index = 0; index < inputs; ++index)
+            items_.push_back({ static_cast<uint32_t>(position),
+                static_cast<uint32_t>(index) });
+    }
+}
+
+bool input_work_list::claim(size_t size, iterator& begin, iterator& end)
+{
+    BITCOIN_ASSERT(size != 0);
+    const auto first = cursor_.fetch_add(size);
+
+    if (first >= items_.size())
+        return false;
+
+    begin = items_.begin() + first;
+    end = items_.begin() + std::min(first + size, items_.size());
+    return true;
+}
+
+size_t input_work_list::chunk_size(size_t workers) const
+{
+    const auto divisor = std::max(workers, size_t(1)) * chunks_per_worker;
+    return std::max(size_t(1), std::min(maximum_chunk, size() / divisor));
+}
+
+size_t input_work_list::skipped() const
+{
+    return skipped_;
+}
+
+size_t input_work_list::size() const
+{
+    return items_.size();
+}
+
+bool input_work_list::empty() const
+{
+    return items_.empty();
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -54,7 +54,17 @@ void populate_base::populate_pooled(const chain::transaction& tx,
 {
     size_t height;
     size_t position;
+    uint32_t pooled_forks;
 
+    // Txs pooled since startup are indexed in memory, avoiding the store.
+    if (fast_chain_.get_pooled_forks(pooled_forks, tx.hash()))
+    {
+        tx.validation.pooled = true;
+        tx.validation.current = (pooled_forks == forks);
+        return;
+    }
+
+    // A miss may still be an unconfirmed tx stored before startup.
     if (fast_chain_.get_transaction_position(height, position, tx.hash(),
         false) && (position == transaction_database::unconfirmed))
     {
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
@@ -70,13 +71,16 @@ void populate_block::populate(branch::const_ptr branch,
         return;
     }
 
+    // Inputs are claimed in chunks from one list shared by all buckets.
+    const auto work = std::make_shared<input_work_list>(*block, false);
+
     const auto buckets = std::min(dispatch_.size(), non_coinbase_inputs);
     const auto join_handler = synchronize(std::move(handler), buckets, NAME);
     BITCOIN_ASSERT(buckets != 0);
 
     for (size_t bucket = 0; bucket < buckets; ++bucket)
         dispatch_.concurrent(&populate_block::populate_transactions,
-            this, branch, bucket, buckets, join_handler);
+            this, branch, bucket, buckets, work, join_handler);
 }
 
 // Initialize the coinbase input for subsequent validation.
@@ -126,13 +130,13 @@ void populate_block::populate_coinbase(branch::const_ptr branch,
 ////}
 
 void populate_block::populate_transactions(branch::const_ptr branch,
-    size_t bucket, size_t buckets, result_handler handler) const
+    size_t bucket, size_t buckets, input_work_list::ptr work,
+    result_handler handler) const
 {
     BITCOIN_ASSERT(bucket < buckets);
     const auto block = branch->top();
     const auto branch_height = branch->height();
     const auto& txs = block->transactions();
-    size_t input_position = 0;
 
     const auto state = block->validation.state;
     const auto forks = state->enabled_forks();
@@ -168,18 +172,16 @@ void populate_block::populate_transactions(branch::const_ptr branch,
         }
     }
 
-    // Must skip coinbase here as it is already accounted for.
-    for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx)
-    {
-        const auto& inputs = tx->inputs();
+    input_work_list::iterator begin;
+    input_work_list::iterator end;
+    const auto chunk = work->chunk_size(buckets);
 
-        for (size_t input_index = 0; input_index < inputs.size();
-            ++input_index, ++input_position)
+    // The work list excludes the coinbase, which is already accounted for.
+    while (work->claim(chunk, begin, end))
+    {
+        for (auto item = begin; item != end; ++item)
         {
-            if (input_position % buckets != bucket)
-                continue;
-
-            const auto& input = inputs[input_index];
+            const auto& input = txs[item->transaction].inputs()[item->input];
             const auto& prevout = input.previous_output();
             populate_base::populate_prevout(branch_height, prevout, true);
             populate_prevout(branch, prevout);
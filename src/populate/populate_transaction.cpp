@@ -45,6 +45,12 @@ populate_transaction::populate_transaction(dispatcher& dispatch,
 
 void populate_transaction::populate(transaction_const_ptr tx,
     result_handler&& handler) const
+{
+    populate(tx, false, std::move(handler));
+}
+
+void populate_transaction::populate(transaction_const_ptr tx, bool repool,
+    result_handler&& handler) const
 {
     const auto state = tx->validation.state;
     BITCOIN_ASSERT(state);
@@ -61,7 +67,9 @@ void populate_transaction::populate(transaction_const_ptr tx,
     // We must allow collisions in *block* validation if that is configured as
     // otherwise will will not follow the chain when a collision is mined.
     //*************************************************************************
-    populate_base::populate_duplicate(chain_height, *tx, false);
+    // A popped tx remains stored as unconfirmed, so would collide with itself
+    // if repooled. Only a collision with a confirmed tx is then rejected.
+    populate_base::populate_duplicate(chain_height, *tx, repool);
 
     // Because txs include no proof of work we much short circuit here.
     // Otherwise a peer can flood us with repeat transactions to validate.
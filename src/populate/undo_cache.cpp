@@ -0,0 +1,195 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/populate/undo_cache.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+
+undo_cache::undo_cache(size_t depth)
+  : depth_(depth),
+    restoring_(false)
+{
+}
+
+void undo_cache::connect(const block& block)
+{
+    if (depth_ == 0)
+        return;
+
+    const auto& txs = block.transactions();
+    record entry{ block.hash(), {} };
+
+    // Prevouts are not populated under checkpoint, so nothing is recorded.
+    for (const auto& tx: txs)
+    {
+        for (const auto& input: tx.inputs())
+        {
+            const auto& outpoint = input.previous_output();
+            const auto& validation = outpoint.validation;
+
+            if (!validation.cache.is_valid())
+                continue;
+
+            entry.prevouts.emplace_back(outpoint, prevout
+            {
+                validation.cache,
+                validation.height,
+                validation.median_time_past,
+                validation.coinbase
+            });
+        }
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (!restored_.empty())
+    {
+        for (const auto& tx: txs)
+            for (const auto& input: tx.inputs())
+                restored_.erase(input.previous_output());
+
+        restoring_ = !restored_.empty();
+    }
+
+    records_.push_back(std::move(entry));
+
+    if (records_.size() > depth_)
+        records_.pop_front();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void undo_cache::disconnect(const block_const_ptr_list& blocks,
+    size_t fork_height)
+{
+    if (depth_ == 0)
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    restored_.clear();
+
+    for (const auto& block: blocks)
+    {
+        const auto hash = block->hash();
+        const auto match = [&hash](const record& entry)
+        {
+            return entry.hash == hash;
+        };
+
+        // A block deeper than the cache is not recorded.
+        const auto it = std::find_if(records_.begin(), records_.end(), match);
+
+        if (it == records_.end())
+            continue;
+
+        // Outputs of disconnected blocks do not exist in the chain.
+        for (const auto& spent: it->prevouts)
+            if (spent.second.height <= fork_height)
+                restored_.insert(spent);
+
+        records_.erase(it);
+    }
+
+    restoring_ = !restored_.empty();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void undo_cache::release(const block_const_ptr_list& blocks)
+{
+    if (!restoring_)
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // A subsequent restoration of a common prevout is also dropped, which
+    // only returns its query to the store.
+    for (const auto& block: blocks)
+        for (const auto& tx: block->transactions())
+            for (const auto& input: tx.inputs())
+                restored_.erase(input.previous_output());
+
+    restoring_ = !restored_.empty();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The restoration does not track confirmation of spends, so as with the
+// store's output cache only queries that do not require confirmation (tx pool
+// revalidation) are answered. Those observe only confirmed spends (see
+// populate_base), and a connected block removes restored outputs it spends.
+bool undo_cache::find(output& out_output, size_t& out_height,
+    uint32_t& out_median_time_past, bool& out_coinbase,
+    const output_point& outpoint, size_t branch_height,
+    bool require_confirmed) const
+{
+    // Avoid the shared lock unless a reorganization has restored outputs.
+    if (require_confirmed || !restoring_)
+        return false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    const auto it = restored_.find(outpoint);
+
+    if (it == restored_.end() || it->second.height > branch_height)
+        return false;
+
+    out_output = it->second.output;
+    out_height = it->second.height;
+    out_median_time_past = it->second.median_time_past;
+    out_coinbase = it->second.coinbase;
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The output was spent only by a disconnected block.
+    out_output.validation.spender_height = output::validation::not_spent;
+    return true;
+}
+
+size_t undo_cache::depth() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return records_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t undo_cache::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return restored_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -31,6 +31,13 @@ settings::settings()
   , minimum_output_satoshis(500)
   , notify_limit_hours(24)
   , reorganization_limit(256)
+  , script_cache_capacity(100000)
+  , reject_filter_capacity(50000)
+  , admission_queue_capacity(1000)
+  , block_queue_capacity(100)
+  , pooled_transaction_capacity(200000)
+  , duplicate_filter_capacity(0)
+  , undo_cache_depth(1)
   , allow_collisions(true)
   , easy_blocks(false)
   , retarget(true)
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/validate/script_cache.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+
+static data_chunk random_salt()
+{
+    data_chunk salt(hash_size);
+    pseudo_random_fill(salt);
+    return salt;
+}
+
+script_cache::script_cache(size_t capacity)
+  : shard_capacity_(capacity == 0 ? 0 : (capacity - 1) / shard_count + 1),
+    salt_(random_salt())
+{
+}
+
+// The salt prevents an attacker from targeting shards or forcing evictions.
+hash_digest script_cache::key(const transaction& tx, uint32_t input_index,
+    uint32_t forks) const
+{
+#ifdef BITPRIM_CURRENCY_BCH
+    const auto hash = tx.hash();
+#else
+    // The witness hash commits to the witness, which is script verified.
+    const auto hash = tx.hash(true);
+#endif
+
+    auto data = build_chunk({ salt_, hash }, 2 * sizeof(uint32_t));
+    extend_data(data, to_little_endian(input_index));
+    extend_data(data, to_little_endian(forks));
+    return sha256_hash(data);
+}
+
+script_cache::shard& script_cache::select(const hash_digest& key) const
+{
+    return shards_[key.front() % shard_count];
+}
+
+bool script_cache::contains(const transaction& tx, uint32_t input_index,
+    uint32_t forks) const
+{
+    if (shard_capacity_ == 0)
+        return false;
+
+    const auto entry = key(tx, input_index, forks);
+    auto& bucket = select(entry);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(bucket.mutex);
+    return bucket.set.find(entry) != bucket.set.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void script_cache::store(const transaction& tx, uint32_t input_index,
+    uint32_t forks)
+{
+    if (shard_capacity_ == 0)
+        return;
+
+    const auto entry = key(tx, input_index, forks);
+    auto& bucket = select(entry);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(bucket.mutex);
+
+    if (!bucket.set.insert(entry).second)
+        return;
+
+    bucket.order.push_back(entry);
+
+    // Evict the oldest entry once the shard is full.
+    if (bucket.order.size() > shard_capacity_)
+    {
+        bucket.set.erase(bucket.order.front());
+        bucket.order.pop_front();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t script_cache::size() const
+{
+    size_t count = 0;
+
+    for (auto& bucket: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(bucket.mutex);
+        count += bucket.set.size();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return count;
+}
+
+void script_cache::clear()
+{
+    for (auto& bucket: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(bucket.mutex);
+        bucket.set.clear();
+        bucket.order.clear();
+        ///////////////////////////////////////////////////////////////////////
+    }
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -19,6 +19,7 @@
 #include <bitcoin/blockchain/validate/validate_block.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -40,6 +41,9 @@ using namespace std::placeholders;
 
 #define NAME "validate_block"
 
+// Blocks with fewer txs are checked on one thread, which is more efficient.
+static const size_t parallel_check_transactions = 2000;
+
 // Database access is limited to: populator:
 // spend: { spender }
 // block: { bits, version, timestamp }
@@ -49,10 +53,15 @@ using namespace std::placeholders;
 // will never be invoked, resulting in a threadpool.join indefinite hang.
 
 validate_block::validate_block(dispatcher& dispatch, const fast_chain& chain,
-    const settings& settings, bool relay_transactions)
+    const script_cache& cache, const settings& settings,
+    bool relay_transactions)
   : stopped_(true),
     fast_chain_(chain),
     priority_dispatch_(dispatch),
+    script_cache_(cache),
+    assume_valid_(settings.assume_valid),
+    current_(),
+    last_(),
     block_populator_(dispatch, chain, relay_transactions)
 {
 }
@@ -87,11 +96,13 @@ void validate_block::check(block_const_ptr block, result_handler handler) const
         std::bind(&validate_block::handle_checked,
             this, _1, block, handler);
 
+    const auto count = block->transactions().size();
+
     // TODO: make configurable for each parallel segment.
-    // This one is more efficient with one thread than parallel.
-    const auto threads = std::min(size_t(1), priority_dispatch_.size());
+    // Small blocks are more efficient with one thread than parallel.
+    const auto threads = count < parallel_check_transactions ? size_t(1) :
+        priority_dispatch_.size();
 
-    const auto count = block->transactions().size();
     const auto buckets = std::min(threads, count);
     BITCOIN_ASSERT(buckets != 0);
 
@@ -131,6 +142,7 @@ void validate_block::handle_checked(const code& ec, block_const_ptr block,
     }
 
     // Run context free checks, sets time internally.
+    // The merkle root is computed from the tx hashes cached above.
     handler(block->check());
 }
 
@@ -138,12 +150,40 @@ void validate_block::handle_checked(const code& ec, block_const_ptr block,
 //-----------------------------------------------------------------------------
 // These checks require chain state, and block state if not under checkpoint.
 
-void validate_block::accept(branch::const_ptr branch,
+// Header checks are sufficient to park a block that lacks the work to
+// reorganize, its body is accepted only once its branch can reorganize.
+code validate_block::accept_header(branch::const_ptr branch) const
+{
+    const auto block = branch->top();
+    BITCOIN_ASSERT(block);
+
+    // Populate chain state for the next block.
+    block->validation.state = fast_chain_.chain_state(branch);
+
+    if (!block->validation.state)
+        return error::operation_failed_19;
+
+    // Bits, timestamp, version and checkpoint checks (proof is checked).
+    const auto ec = block->header().accept(*block->validation.state);
+
+    if (ec)
+        return ec;
+
+    return is_assumed_valid_conflict(block) ? error::checkpoints_failed :
+        error::success;
+}
+
+void validate_block::accept(branch::const_ptr branch, duration checked,
     result_handler handler) const
 {
     const auto block = branch->top();
     BITCOIN_ASSERT(block);
 
+    // Reset statistics for each block, checks may have run concurrently.
+    current_ = statistics();
+    current_.transactions = block->transactions().size();
+    current_.check = checked;
+
     // The block has no population timer, so set externally.
     block->validation.start_populate = asio::steady_clock::now();
 
@@ -177,6 +217,14 @@ void validate_block::handle_populated(const code& ec, block_const_ptr block,
         return;
     }
 
+    const auto& validation = block->validation;
+    current_.height = validation.state->height();
+    current_.populate = elapsed(validation.start_populate);
+
+    // Each non-coinbase prevout is populated unless under checkpoint.
+    if (!validation.state->is_under_checkpoint())
+        current_.prevouts = block->total_inputs(false);
+
     // Run contextual block non-tx checks (sets start time).
     const auto error_code = block->accept(false);
 
@@ -186,7 +234,13 @@ void validate_block::handle_populated(const code& ec, block_const_ptr block,
         return;
     }
 
-    const auto sigops = std::make_shared<atomic_counter>(0);
+    // The assumed valid block is a checkpoint, see is_assumed_valid.
+    if (is_assumed_valid_conflict(block))
+    {
+        handler(error::checkpoints_failed);
+        return;
+    }
+
     const auto state = block->validation.state;
     BITCOIN_ASSERT(state);
 #ifdef BITPRIM_CURRENCY_BCH
@@ -195,9 +249,15 @@ void validate_block::handle_populated(const code& ec, block_const_ptr block,
     const auto bip141 = state->is_enabled(rule_fork::bip141_rule);
 #endif
 
+    const auto count = block->transactions().size();
+    const auto buckets = std::min(priority_dispatch_.size(), count);
+    BITCOIN_ASSERT(buckets != 0);
+
+    const auto workers = std::make_shared<worker_list>(buckets);
+
     result_handler complete_handler =
         std::bind(&validate_block::handle_accepted,
-            this, _1, block, sigops, bip141, handler);
+            this, _1, block, workers, bip141, handler);
 
     if (state->is_under_checkpoint())
     {
@@ -205,22 +265,20 @@ void validate_block::handle_populated(const code& ec, block_const_ptr block,
         return;
     }
 
-    const auto count = block->transactions().size();
     const auto bip16 = state->is_enabled(rule_fork::bip16_rule);
-    const auto buckets = std::min(priority_dispatch_.size(), count);
-    BITCOIN_ASSERT(buckets != 0);
-
+    const auto cancel = std::make_shared<cancel_token>(false);
     const auto join_handler = synchronize(std::move(complete_handler), buckets,
         NAME "_accept");
 
     for (size_t bucket = 0; bucket < buckets; ++bucket)
         priority_dispatch_.concurrent(&validate_block::accept_transactions,
-            this, block, bucket, buckets, sigops, bip16, bip141, join_handler);
+            this, block, bucket, buckets, workers, cancel, bip16, bip141,
+            join_handler);
 }
 
 void validate_block::accept_transactions(block_const_ptr block, size_t bucket,
-    size_t buckets, atomic_counter_ptr sigops, bool bip16, bool bip141,
-    result_handler handler) const
+    size_t buckets, worker_list_ptr workers, cancel_token_ptr cancel,
+    bool bip16, bool bip141, result_handler handler) const
 {
 #ifdef BITPRIM_CURRENCY_BCH
     bip141 = false;
@@ -232,6 +290,7 @@ void validate_block::accept_transactions(block_const_ptr block, size_t bucket,
     }
 
     code ec(error::success);
+    size_t sigops = 0;
     const auto& state = *block->validation.state;
     const auto& txs = block->transactions();
     const auto count = txs.size();
@@ -239,29 +298,48 @@ void validate_block::accept_transactions(block_const_ptr block, size_t bucket,
     // Run contextual tx non-script checks (not in tx order).
     for (auto tx = bucket; tx < count && !ec; tx = ceiling_add(tx, buckets))
     {
+        // Another bucket has failed, its error completes the join.
+        if (*cancel)
+            break;
+
         const auto& transaction = txs[tx];
         ec = transaction.accept(state, false);
-        *sigops += transaction.signature_operations(bip16, bip141);
+        sigops += transaction.signature_operations(bip16, bip141);
     }
 
+    if (ec)
+        *cancel = true;
+
+    (*workers)[bucket].sigops = sigops;
     handler(ec);
 }
 
 void validate_block::handle_accepted(const code& ec, block_const_ptr block,
-    atomic_counter_ptr sigops, bool bip141, result_handler handler) const
+    worker_list_ptr workers, bool bip141, result_handler handler) const
 {
+    current_.accept = elapsed(block->validation.start_populate) -
+        current_.populate;
+
+    // The join completes on first error, other buckets may still be writing.
     if (ec)
     {
         handler(ec);
         return;
     }
 
+    size_t sigops = 0;
+
+    for (const auto& worker: *workers)
+        sigops += worker.sigops;
+
+    current_.sigops = sigops;
+
 #ifdef BITPRIM_CURRENCY_BCH
     size_t allowed_sigops = get_allowed_sigops(block->serialized_size(1));
-    const auto exceeded = *sigops > allowed_sigops;
+    const auto exceeded = sigops > allowed_sigops;
 #else
     const auto max_sigops = bip141 ? max_fast_sigops : get_allowed_sigops(block->serialized_size(1));
-    const auto exceeded = *sigops > max_sigops;
+    const auto exceeded = sigops > max_sigops;
 #endif
     handler(exceeded ? error::block_embedded_sigop_limit : error::success);
 }
@@ -272,111 +350,295 @@ void validate_block::handle_accepted(const code& ec, block_const_ptr block,
 
 void validate_block::connect(branch::const_ptr branch,
     result_handler handler) const
+{
+    connect(branch, branch, handler);
+}
+
+void validate_block::connect(branch::const_ptr branch, branch::const_ptr path,
+    result_handler handler) const
 {
     const auto block = branch->top();
     BITCOIN_ASSERT(block && block->validation.state);
 
     // We are reimplementing connect, so must set timer externally.
     block->validation.start_connect = asio::steady_clock::now();
+    const auto no_workers = std::make_shared<worker_list>();
 
     if (block->validation.state->is_under_checkpoint()) {
-        handler(error::success);
+        handle_connected(error::success, block, no_workers, handler);
+        return;
+    }
+
+    // Prevouts are populated and accepted, only scripts are not verified.
+    if (is_assumed_valid(block->validation.state->height(), path)) {
+        handle_connected(error::success, block, no_workers, handler);
         return;
     }
 
-    const auto non_coinbase_inputs = block->total_inputs(false);
+    current_.inputs = block->total_inputs(false);
 
     // Return if there are no non-coinbase inputs to validate.
-    if (non_coinbase_inputs == 0) {
-        handler(error::success);
+    if (current_.inputs == 0) {
+        handle_connected(error::success, block, no_workers, handler);
+        return;
+    }
+
+    // Inputs of txs pooled with current fork state are not verified.
+    const auto work = std::make_shared<input_work_list>(*block, true);
+    current_.pooled = work->skipped();
+
+    if (work->empty()) {
+        handle_connected(error::success, block, no_workers, handler);
         return;
     }
 
-    // Reset statistics for each block (treat coinbase as cached).
-    hits_ = 0;
-    queries_ = 0;
+    // Serialize each tx once, to be shared by all of its input verifications.
+    const auto non_coinbase_txs = block->transactions().size() - 1u;
+    const auto serials = std::make_shared<data_stack>(non_coinbase_txs + 1u);
 
+#ifndef WITH_CONSENSUS
+    // Native script verification does not read the serialization.
+    handle_serialized(error::success, block, work, serials, handler);
+#else
     result_handler complete_handler =
-        std::bind(&validate_block::handle_connected,
-            this, _1, block, handler);
+        std::bind(&validate_block::handle_serialized,
+            this, _1, block, work, serials, handler);
+
+    const auto threads = priority_dispatch_.size();
+    const auto buckets = std::min(threads, non_coinbase_txs);
+    BITCOIN_ASSERT(buckets != 0);
+
+    const auto join_handler = synchronize(std::move(complete_handler), buckets,
+        NAME "_serialize");
+
+    for (size_t bucket = 0; bucket < buckets; ++bucket)
+        priority_dispatch_.concurrent(&validate_block::serialize_transactions,
+            this, block, bucket, buckets, serials, join_handler);
+#endif
+}
+
+#ifdef WITH_CONSENSUS
+void validate_block::serialize_transactions(block_const_ptr block,
+    size_t bucket, size_t buckets, data_stack_ptr serials,
+    result_handler handler) const
+{
+    BITCOIN_ASSERT(bucket < buckets);
+    const auto& txs = block->transactions();
+
+    // Each bucket writes only its own positions (coinbase is not verified).
+    for (auto position = bucket + 1u; position < txs.size();
+        position = ceiling_add(position, buckets))
+    {
+        if (stopped())
+        {
+            handler(error::service_stopped);
+            return;
+        }
+
+        if (!txs[position].validation.current)
+            (*serials)[position] = validate_input::serialize(txs[position]);
+    }
+
+    handler(error::success);
+}
+#endif
+
+void validate_block::handle_serialized(const code& ec, block_const_ptr block,
+    input_work_list::ptr work, data_stack_ptr serials,
+    result_handler handler) const
+{
+    if (ec)
+    {
+        handler(ec);
+        return;
+    }
 
     const auto threads = priority_dispatch_.size();
-    const auto buckets = std::min(threads, non_coinbase_inputs);
+    const auto buckets = std::min(threads, work->size());
     BITCOIN_ASSERT(buckets != 0);
 
+    const auto workers = std::make_shared<worker_list>(buckets);
+    const auto cancel = std::make_shared<cancel_token>(false);
+
+    result_handler complete_handler =
+        std::bind(&validate_block::handle_connected,
+            this, _1, block, workers, handler);
+
     const auto join_handler = synchronize(std::move(complete_handler), buckets,
         NAME "_validate");
 
+    // The serials are read-only from here on.
     for (size_t bucket = 0; bucket < buckets; ++bucket)
         priority_dispatch_.concurrent(&validate_block::connect_inputs,
-            this, block, bucket, buckets, join_handler);
+            this, block, bucket, buckets, work, serials, workers, cancel,
+            join_handler);
 }
 
+// Buckets claim chunks of inputs until the work list is exhausted.
 void validate_block::connect_inputs(block_const_ptr block, size_t bucket,
-    size_t buckets, result_handler handler) const
+    size_t buckets, input_work_list::ptr work, data_stack_ptr serials,
+    worker_list_ptr workers, cancel_token_ptr cancel,
+    result_handler handler) const
 {
     BITCOIN_ASSERT(bucket < buckets);
     code ec(error::success);
     const auto forks = block->validation.state->enabled_forks();
     const auto& txs = block->transactions();
-    size_t position = 0;
-
-    // Must skip coinbase here as it is already accounted for.
-    for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx) {
-        ++queries_;
-
-        // The tx is pooled with current fork state so outputs are validated.
-        if (tx->validation.current) {
-            ++hits_;
-            continue;
-        }
-
-        size_t input_index;
-        const auto& inputs = tx->inputs();
+    const auto chunk = work->chunk_size(buckets);
+    input_work_list::iterator begin;
+    input_work_list::iterator end;
+    auto& stats = (*workers)[bucket];
 
-        for (input_index = 0; input_index < inputs.size(); ++input_index, ++position) {
-            if (position % buckets != bucket)
-                continue;
+    // Reused for each prevout script verified by this bucket.
+    data_chunk script_buffer;
 
+    // Another bucket has failed if cancelled, its error completes the join.
+    while (!ec && !*cancel && work->claim(chunk, begin, end)) {
+        for (auto item = begin; item != end; ++item) {
             if (stopped()) {
-                handler(error::service_stopped);
-                return;
+                ec = error::service_stopped;
+                break;
             }
 
-            const auto& prevout = inputs[input_index].previous_output();
+            const auto& tx = txs[item->transaction];
+            const auto input_index = item->input;
+            const auto& prevout = tx.inputs()[input_index].previous_output();
 
             if (!prevout.validation.cache.is_valid()) {
                 ec = error::missing_previous_output;
-                break;
             }
 
-            if ((ec = validate_input::verify_script(*tx, input_index, forks))) {
+            // The input was verified under these forks by the tx pool.
+            else if (script_cache_.contains(tx, input_index, forks)) {
+                ++stats.cache_hits;
+                continue;
+            }
+
+            else {
+                ++stats.verified;
+                ec = validate_input::verify_script(tx, input_index, forks,
+                    (*serials)[item->transaction], script_buffer);
+            }
+
+            if (ec) {
+                const auto height = block->validation.state->height();
+                dump(ec, tx, input_index, forks, height);
                 break;
             }
         }
+    }
 
-        if (ec) {
-            const auto height = block->validation.state->height();
-            dump(ec, *tx, input_index, forks, height);
-            break;
+    if (ec)
+        *cancel = true;
+
+    handler(ec);
+}
+
+void validate_block::handle_connected(const code& ec, block_const_ptr block,
+    worker_list_ptr workers, result_handler handler) const
+{
+    // The join completes on first error, other buckets may still be writing.
+    if (!ec) {
+        for (const auto& worker: *workers) {
+            current_.cache_hits += worker.cache_hits;
+            current_.verified += worker.verified;
         }
     }
 
+    current_.connect = elapsed(block->validation.start_connect);
+
+    // The share of inputs verified in advance by the tx pool.
+    const auto inputs = current_.inputs;
+    block->validation.cache_efficiency = inputs == 0 ? 0.0f :
+        (inputs - current_.verified) * 1.0f / inputs;
+
+    publish();
     handler(ec);
 }
 
-// The tx pool cache hit rate.
-float validate_block::hit_rate() const
+validate_block::statistics validate_block::last_statistics() const
 {
-    // These values could overflow or divide by zero, but that's okay.
-    return queries_ == 0 ? 0.0f : (hits_ * 1.0f / queries_);
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return last_;
+    ///////////////////////////////////////////////////////////////////////////
 }
 
-void validate_block::handle_connected(const code& ec, block_const_ptr block,
-    result_handler handler) const
+void validate_block::publish() const
 {
-    block->validation.cache_efficiency = hit_rate();
-    handler(ec);
+    const auto stats = current_;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    last_ = stats;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    LOG_DEBUG(LOG_BLOCKCHAIN)
+        << "Block [" << stats.height << "] txs (" << stats.transactions
+        << ") inputs (" << stats.inputs << ") pooled txs (" << stats.pooled
+        << ") prevouts (" << stats.prevouts << ") cached (" << stats.cache_hits
+        << ") verified (" << stats.verified << ") sigops (" << stats.sigops
+        << ") check " << stats.check.count() << "us populate "
+        << stats.populate.count() << "us accept " << stats.accept.count()
+        << "us connect " << stats.connect.count() << "us";
+}
+
+// Assume valid.
+//-----------------------------------------------------------------------------
+// The assumed valid block is enforced as a checkpoint: a block at its height
+// with another hash is rejected. So no chain continues above its height other
+// than through it, and a block below it is its ancestor on any chain that can
+// reach the height, as with the configured checkpoints.
+
+// The path is the store to its fork point and the branch above it. If either
+// reaches the assumed valid height its block must be there, as a store that
+// reaches it is replaced there by a path that forks below it. Otherwise the
+// path extends toward the block, which it can pass only as its ancestor.
+bool validate_block::is_assumed_valid(const config::checkpoint& assume_valid,
+    size_t height, branch::const_ptr path, size_t top)
+{
+    if (assume_valid.hash() == null_hash || height > assume_valid.height())
+        return false;
+
+    if (assume_valid.height() <= path->top_height())
+    {
+        hash_digest hash;
+        return path->get_block_hash(hash, assume_valid.height()) &&
+            hash == assume_valid.hash();
+    }
+
+    return assume_valid.height() > top;
+}
+
+bool validate_block::is_assumed_valid_conflict(
+    const config::checkpoint& assume_valid, size_t height,
+    const hash_digest& hash)
+{
+    return assume_valid.hash() != null_hash &&
+        height == assume_valid.height() && hash != assume_valid.hash();
+}
+
+bool validate_block::is_assumed_valid(size_t height,
+    branch::const_ptr path) const
+{
+    size_t top;
+    return fast_chain_.get_last_height(top) &&
+        is_assumed_valid(assume_valid_, height, path, top);
+}
+
+bool validate_block::is_assumed_valid_conflict(block_const_ptr block) const
+{
+    return is_assumed_valid_conflict(assume_valid_,
+        block->validation.state->height(), block->hash());
+}
+
+validate_block::duration validate_block::elapsed(asio::time_point start)
+{
+    return std::chrono::duration_cast<duration>(
+        asio::steady_clock::now() - start);
 }
 
 // Utility.
@@ -175,39 +175,40 @@ code validate_input::convert_result(verify_result_type result)
     }
 }
 
-// TODO: cache transaction wire serialization.
 code validate_input::verify_script(const transaction& tx, uint32_t input_index,
     uint32_t branches) {
+    data_chunk script_buffer;
+    return verify_script(tx, input_index, branches, serialize(tx),
+        script_buffer);
+}
 
-#ifdef BITPRIM_CURRENCY_BCH
-    bool witness = false;
-#else
-    bool witness = true;
-#endif
+// Wire serialization is passed in support of large numbers of inputs.
+code validate_input::verify_script(const transaction& tx, uint32_t input_index,
+    uint32_t branches, const data_chunk& tx_data, data_chunk& script_buffer) {
 
     BITCOIN_ASSERT(input_index < tx.inputs().size());
     const auto& prevout = tx.inputs()[input_index].previous_output().validation;
-    const auto script_data = prevout.cache.script().to_data(false);
-    const auto prevout_value = prevout.cache.value();
-
-    // const auto amount = bitcoin_cash ? prevout.cache.value() : 0;
     const auto amount = prevout.cache.value();
-    // const auto prevout_value = prevout.cache.value();
 
-    // Wire serialization is cached in support of large numbers of inputs.
-    const auto tx_data = tx.to_data(true, witness, false);
+    // Serialize the prevout script into the caller's buffer, reusing its
+    // allocation across inputs.
+    script_buffer.clear();
+    data_sink ostream(script_buffer);
+    ostream_writer sink(ostream);
+    prevout.cache.script().to_data(sink, false);
+    ostream.flush();
 
 #ifdef BITPRIM_CURRENCY_BCH
     auto res = consensus::verify_script(tx_data.data(),
-        tx_data.size(), script_data.data(), script_data.size(), input_index,
-        convert_flags(branches), amount);
+        tx_data.size(), script_buffer.data(), script_buffer.size(),
+        input_index, convert_flags(branches), amount);
 
     return convert_result(res);
 
 #else // BITPRIM_CURRENCY_BCH
 
     auto res = consensus::verify_script(tx_data.data(),
-        tx_data.size(), script_data.data(), script_data.size(), amount,
+        tx_data.size(), script_buffer.data(), script_buffer.size(), amount,
         input_index, convert_flags(branches));
 
     return convert_result(res);
@@ -228,7 +229,20 @@ code validate_input::verify_script(transaction const& tx, uint32_t input_index,
     return script::verify(tx, input_index, forks);
 }
 
+code validate_input::verify_script(transaction const& tx, uint32_t input_index,
+    uint32_t forks, data_chunk const&, data_chunk&) {
+    return verify_script(tx, input_index, forks);
+}
+
 #endif //WITH_CONSENSUS
 
+data_chunk validate_input::serialize(transaction const& tx) {
+#ifdef BITPRIM_CURRENCY_BCH
+    return tx.to_data(true, false, false);
+#else
+    return tx.to_data(true, true, false);
+#endif
+}
+
 } // namespace blockchain
 } // namespace libbitcoin
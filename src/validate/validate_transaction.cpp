@@ -46,10 +46,11 @@ using namespace std::placeholders;
 // transaction: { exists, height, output }
 
 validate_transaction::validate_transaction(dispatcher& dispatch,
-    const fast_chain& chain, const settings& settings)
+    const fast_chain& chain, script_cache& cache, const settings& settings)
   : stopped_(true),
     retarget_(settings.retarget),
     dispatch_(dispatch),
+    script_cache_(cache),
     transaction_populator_(dispatch, chain),
     fast_chain_(chain)
 {
@@ -85,6 +86,26 @@ void validate_transaction::check(transaction_const_ptr tx,
 
 void validate_transaction::accept(transaction_const_ptr tx,
     result_handler handler) const
+{
+    accept(tx, false, handler);
+}
+
+void validate_transaction::accept(transaction_const_ptr tx, bool repool,
+    result_handler handler) const
+{
+    populate(tx, repool,
+        std::bind(&validate_transaction::handle_populated,
+            this, _1, tx, handler));
+}
+
+void validate_transaction::populate(transaction_const_ptr tx,
+    result_handler handler) const
+{
+    populate(tx, false, handler);
+}
+
+void validate_transaction::populate(transaction_const_ptr tx, bool repool,
+    result_handler handler) const
 {
     // Populate chain state of the next block (tx pool).
     tx->validation.state = fast_chain_.chain_state();
@@ -95,9 +116,7 @@ void validate_transaction::accept(transaction_const_ptr tx,
         return;
     }
 
-    transaction_populator_.populate(tx,
-        std::bind(&validate_transaction::handle_populated,
-            this, _1, tx, handler));
+    transaction_populator_.populate(tx, repool, std::move(handler));
 }
 
 void validate_transaction::handle_populated(const code& ec,
@@ -142,20 +161,27 @@ void validate_transaction::connect(transaction_const_ptr tx,
     const auto join_handler = synchronize(handler, buckets, NAME "_validate");
     BITCOIN_ASSERT(buckets != 0);
 
+    // Serialize once, shared read-only by all input verifications.
+    const auto tx_data = std::make_shared<const data_chunk>(
+        validate_input::serialize(*tx));
+
     // If the priority threadpool is shut down when this is called the handler
     // will never be invoked, resulting in a threadpool.join indefinite hang.
     for (size_t bucket = 0; bucket < buckets; ++bucket)
         dispatch_.concurrent(&validate_transaction::connect_inputs,
-            this, tx, bucket, buckets, join_handler);
+            this, tx, bucket, buckets, tx_data, join_handler);
 }
 
-void validate_transaction::connect_inputs(transaction_const_ptr tx, size_t bucket, size_t buckets, result_handler handler) const
+void validate_transaction::connect_inputs(transaction_const_ptr tx, size_t bucket, size_t buckets, data_chunk_const_ptr tx_data, result_handler handler) const
 {
     BITCOIN_ASSERT(bucket < buckets);
     code ec(error::success);
     const auto forks = tx->validation.state->enabled_forks();
     const auto& inputs = tx->inputs();
 
+    // Reused for each prevout script verified by this bucket.
+    data_chunk script_buffer;
+
     for (auto input_index = bucket; input_index < inputs.size(); input_index = ceiling_add(input_index, buckets)) {
         if (stopped()) {
             ec = error::service_stopped;
@@ -169,9 +195,13 @@ void validate_transaction::connect_inputs(transaction_const_ptr tx, size_t bucke
             break;
         }
 
-        if ((ec = validate_input::verify_script(*tx, input_index, forks))) {
+        if ((ec = validate_input::verify_script(*tx, input_index, forks,
+            *tx_data, script_buffer))) {
             break;
         }
+
+        // Each input verification is independent of the others.
+        script_cache_.store(*tx, input_index, forks);
     }
 
     handler(ec);
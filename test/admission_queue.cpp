@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(admission_queue_tests)
+
+// Wait until the given number of entries are queued.
+static void wait_depth(const admission_queue& instance, size_t depth)
+{
+    while (instance.stats().depth != depth)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+BOOST_AUTO_TEST_CASE(admission_queue__enter__free_slot__success)
+{
+    admission_queue instance(10, 2);
+    BOOST_REQUIRE_EQUAL(instance.enter(0), error::success);
+    BOOST_REQUIRE_EQUAL(instance.enter(0), error::success);
+
+    const auto stats = instance.stats();
+    BOOST_REQUIRE_EQUAL(stats.active, 2u);
+    BOOST_REQUIRE_EQUAL(stats.admitted, 2u);
+    BOOST_REQUIRE_EQUAL(stats.depth, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(admission_queue__enter__full_zero_capacity__oversubscribed)
+{
+    admission_queue instance(0, 1);
+    BOOST_REQUIRE_EQUAL(instance.enter(0), error::success);
+    BOOST_REQUIRE_EQUAL(instance.enter(42), error::oversubscribed);
+    BOOST_REQUIRE_EQUAL(instance.stats().shed, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(admission_queue__enter__stopped__service_stopped)
+{
+    admission_queue instance(10, 1);
+    instance.stop();
+    BOOST_REQUIRE_EQUAL(instance.enter(0), error::service_stopped);
+}
+
+BOOST_AUTO_TEST_CASE(admission_queue__leave__waiter__admitted)
+{
+    admission_queue instance(10, 1);
+    BOOST_REQUIRE_EQUAL(instance.enter(0), error::success);
+
+    auto waiter = std::async(std::launch::async,
+        [&instance]() { return instance.enter(1); });
+
+    wait_depth(instance, 1);
+    instance.leave();
+    BOOST_REQUIRE_EQUAL(waiter.get(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.stats().admitted, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(admission_queue__enter__full_higher_priority__sheds_lowest)
+{
+    admission_queue instance(1, 1);
+    BOOST_REQUIRE_EQUAL(instance.enter(0), error::success);
+
+    auto low = std::async(std::launch::async,
+        [&instance]() { return instance.enter(1); });
+
+    wait_depth(instance, 1);
+
+    auto high = std::async(std::launch::async,
+        [&instance]() { return instance.enter(2); });
+
+    BOOST_REQUIRE_EQUAL(low.get(), error::oversubscribed);
+    wait_depth(instance, 1);
+    instance.leave();
+    BOOST_REQUIRE_EQUAL(high.get(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(admission_queue__stop__waiter__service_stopped)
+{
+    admission_queue instance(10, 1);
+    BOOST_REQUIRE_EQUAL(instance.enter(0), error::success);
+
+    auto waiter = std::async(std::launch::async,
+        [&instance]() { return instance.enter(1); });
+
+    wait_depth(instance, 1);
+    instance.stop();
+    BOOST_REQUIRE_EQUAL(waiter.get(), error::service_stopped);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -805,6 +805,130 @@ BOOST_AUTO_TEST_CASE(block_chain__fetch_locator_block_headers__limited__sequenti
     BOOST_REQUIRE_EQUAL(fetch_locator_block_headers(instance, locator, null_hash, 2), error::success);
 }
 
+// repool
+
+// Outputs are spendable by an empty input script.
+static chain::script true_script()
+{
+    return chain::script{ data_chunk{ 0x51 }, false };
+}
+
+// A coinbase is made distinct by its id.
+static chain::transaction make_coinbase(uint8_t id)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ null_hash,
+        chain::point::null_index }, chain::script{ data_chunk{ 0x01, id },
+        false }, 0);
+
+    chain::output::list outputs;
+    outputs.emplace_back(50, true_script());
+    return chain::transaction{ 1, 0, std::move(inputs), std::move(outputs) };
+}
+
+static chain::transaction make_spend(const chain::output_point& prevout,
+    uint64_t value)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ prevout }, chain::script{}, 0);
+
+    chain::output::list outputs;
+    outputs.emplace_back(value, true_script());
+    return chain::transaction{ 1, 0, std::move(inputs), std::move(outputs) };
+}
+
+// A block above the parent, with chain state populated as by validation.
+static block_const_ptr make_child(block_chain& instance, uint8_t id,
+    const chain::header& parent, size_t parent_height,
+    chain::transaction::list&& txs)
+{
+    txs.insert(txs.begin(), make_coinbase(id));
+    const auto block = std::make_shared<const message::block>(message::block
+    {
+        chain::header{ 1, parent.hash(), null_hash, parent.timestamp() + 1u,
+            parent.bits(), id },
+        std::move(txs)
+    });
+
+    const auto path = std::make_shared<branch>(parent_height);
+    BOOST_REQUIRE(path->push_front(block));
+    block->validation.state = instance.chain_state(path);
+    BOOST_REQUIRE(block->validation.state);
+    return block;
+}
+
+static code reorganize_block(block_chain& instance, dispatcher& dispatch,
+    const chain::header& fork, size_t fork_height, block_const_ptr incoming,
+    block_const_ptr_list_ptr outgoing)
+{
+    std::promise<code> promise;
+    const auto incoming_blocks = std::make_shared<const block_const_ptr_list>(
+        block_const_ptr_list{ incoming });
+    instance.reorganize({ fork.hash(), fork_height }, incoming_blocks,
+        outgoing, dispatch,
+        [&promise](const code& ec) { promise.set_value(ec); });
+    return promise.get_future().get();
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__repool__disconnected_transaction__pooled)
+{
+    START_BLOCKCHAIN(instance, false);
+    dispatcher dispatch(pool, TEST_NAME);
+    const auto genesis = chain::block::genesis_mainnet().header();
+
+    // The funding tx is not coinbase, so its output is immediately spendable.
+    const chain::output_point unknown{ hash_digest{ { 0x42 } }, 0 };
+    const auto fund = make_spend(unknown, 100000);
+    const auto block1 = make_child(instance, 1, genesis, 0, { fund });
+    const auto none = std::make_shared<block_const_ptr_list>();
+    BOOST_REQUIRE_EQUAL(reorganize_block(instance, dispatch, genesis, 0, block1,
+        none), error::success);
+
+    const auto spend = make_spend({ fund.hash(), 0 }, 50000);
+    const auto block2 = make_child(instance, 2, block1->header(), 1, { spend });
+    BOOST_REQUIRE_EQUAL(reorganize_block(instance, dispatch, block1->header(), 1,
+        block2, none), error::success);
+
+    // Replace block2, which leaves its spend stored as unconfirmed.
+    const auto outgoing = std::make_shared<block_const_ptr_list>();
+    const auto block3 = make_child(instance, 3, block1->header(), 1, {});
+    BOOST_REQUIRE_EQUAL(reorganize_block(instance, dispatch, block1->header(), 1,
+        block3, outgoing), error::success);
+    BOOST_REQUIRE_EQUAL(outgoing->size(), 1u);
+
+    threadpool priority(2);
+    dispatcher priority_dispatch(priority, TEST_NAME "_priority");
+    prioritized_mutex mutex;
+    script_cache cache(0);
+    blockchain::settings settings;
+    transaction_organizer organizer(mutex, priority_dispatch, pool, instance,
+        cache, settings);
+    BOOST_REQUIRE(organizer.start());
+
+    // Each repooled tx is announced as it is pushed to the pool.
+    std::promise<hash_digest> announced;
+    organizer.subscribe([&announced](const code& ec,
+        transaction_const_ptr tx)
+    {
+        if (ec || !tx)
+            return false;
+
+        announced.set_value(tx->hash());
+        return false;
+    });
+
+    std::promise<code> repooled;
+    organizer.repool(outgoing,
+        [&repooled](const code& ec) { repooled.set_value(ec); });
+
+    BOOST_REQUIRE_EQUAL(repooled.get_future().get(), error::success);
+    BOOST_REQUIRE(announced.get_future().get() == spend.hash());
+
+    organizer.stop();
+    priority.shutdown();
+    priority.join();
+}
+
 // TODO: fetch_template
 // TODO: fetch_mempool
 // TODO: filter_blocks
@@ -18,6 +18,7 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <iterator>
 #include <utility>
 #include <bitcoin/blockchain.hpp>
 
@@ -408,6 +409,40 @@ BOOST_AUTO_TEST_CASE(block_pool__prune__partial_branch_expired__partial_branch_d
     BOOST_REQUIRE(entry8 == instance.blocks().right.end());
 }
 
+BOOST_AUTO_TEST_CASE(block_pool__prune__thousands_of_branches__expired_deleted_rest_replanted)
+{
+    static const size_t branches = 2000;
+    block_pool_fixture instance(1000);
+
+    // Each branch is a root at height, a child and a grandchild.
+    for (size_t height = 1; height <= branches; ++height)
+    {
+        const auto id = static_cast<uint32_t>(3 * height);
+        const auto root = make_block(id, height);
+        const auto child = make_block(id + 1, height + 1, root);
+        const auto grandchild = make_block(id + 2, height + 2, child);
+        instance.add(root);
+        instance.add(child);
+        instance.add(grandchild);
+    }
+
+    BOOST_REQUIRE_EQUAL(instance.size(), 3 * branches);
+
+    // Any height less than 1000 (2000 - 1000) should be pruned.
+    instance.prune(branches);
+
+    // 1001 whole branches, plus two nodes of branch 999 and one of 998.
+    BOOST_REQUIRE_EQUAL(instance.size(), 3006u);
+
+    // The 1001 unexpired roots plus two replanted at height 1000.
+    const auto& right = instance.blocks().right;
+    const auto first = right.upper_bound(0);
+    BOOST_REQUIRE(first != right.end());
+    BOOST_REQUIRE_EQUAL(first->first, 1000u);
+    BOOST_REQUIRE_EQUAL(std::distance(first, right.end()), 1003);
+    BOOST_REQUIRE_EQUAL(right.count(1000), 3u);
+}
+
 // filter
 
 BOOST_AUTO_TEST_CASE(block_pool__filter__empty__empty)
@@ -458,6 +493,33 @@ BOOST_AUTO_TEST_CASE(block_pool__filter__matched_blocks__non_blocks_and_mismatch
     BOOST_REQUIRE(message->inventories()[2] == expected3);
 }
 
+BOOST_AUTO_TEST_CASE(block_pool__filter__predicate__pooled_and_predicated_blocks_removed)
+{
+    block_pool_fixture instance(0);
+    const auto block1 = make_block(1, 42);
+    const auto block2 = make_block(2, 43);
+    const auto block3 = make_block(3, 44);
+    instance.add(block1);
+    const auto stored = block2->hash();
+    const message::inventory_vector expected1{ message::inventory::type_id::transaction, stored };
+    const message::inventory_vector expected2{ message::inventory::type_id::block, block3->hash() };
+    message::get_data data
+    {
+        { message::inventory::type_id::block, block1->hash() },
+        expected1,
+        { message::inventory::type_id::block, stored },
+        expected2
+    };
+    const auto message = std::make_shared<message::get_data>(std::move(data));
+    instance.filter(message, [&](const hash_digest& hash)
+    {
+        return hash == stored;
+    });
+    BOOST_REQUIRE_EQUAL(message->inventories().size(), 2u);
+    BOOST_REQUIRE(message->inventories()[0] == expected1);
+    BOOST_REQUIRE(message->inventories()[1] == expected2);
+}
+
 // exists
 
 BOOST_AUTO_TEST_CASE(block_pool__exists__empty__false)
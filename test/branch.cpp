@@ -19,6 +19,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <memory>
+#include <utility>
 #include <bitcoin/blockchain.hpp>
 
 using namespace bc;
@@ -307,4 +308,109 @@ BOOST_AUTO_TEST_CASE(branch__work__two_blocks__expected)
     BOOST_REQUIRE(instance.work() == 0);
 }
 
+// populate_spent
+
+static chain::transaction make_spend(const chain::output_point& prevout)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ prevout }, chain::script{}, 0);
+    chain::output::list outputs(1);
+    return{ 1, 0, std::move(inputs), std::move(outputs) };
+}
+
+BOOST_AUTO_TEST_CASE(branch__populate_spent__spent_below_top__spent)
+{
+    branch instance;
+    DECLARE_BLOCK(block, 0);
+    DECLARE_BLOCK(block, 1);
+    const chain::output_point spent{ hash_digest{ { 0x42 } }, 1 };
+    block0->set_transactions({ chain::transaction{}, make_spend(spent) });
+    block1->header().set_previous_block_hash(block0->hash());
+    BOOST_REQUIRE(instance.push_front(block1));
+    BOOST_REQUIRE(instance.push_front(block0));
+
+    const chain::output_point outpoint{ spent };
+    instance.populate_spent(outpoint);
+    BOOST_REQUIRE(outpoint.validation.spent);
+    BOOST_REQUIRE(outpoint.validation.confirmed);
+}
+
+BOOST_AUTO_TEST_CASE(branch__populate_spent__other_index__unspent)
+{
+    branch instance;
+    DECLARE_BLOCK(block, 0);
+    DECLARE_BLOCK(block, 1);
+    const chain::output_point spent{ hash_digest{ { 0x42 } }, 1 };
+    block0->set_transactions({ chain::transaction{}, make_spend(spent) });
+    block1->header().set_previous_block_hash(block0->hash());
+    BOOST_REQUIRE(instance.push_front(block1));
+    BOOST_REQUIRE(instance.push_front(block0));
+
+    const chain::output_point outpoint{ spent.hash(), 0 };
+    instance.populate_spent(outpoint);
+    BOOST_REQUIRE(!outpoint.validation.spent);
+}
+
+BOOST_AUTO_TEST_CASE(branch__populate_spent__spent_by_top__unspent)
+{
+    branch instance;
+    DECLARE_BLOCK(block, 0);
+    DECLARE_BLOCK(block, 1);
+    const chain::output_point spent{ hash_digest{ { 0x42 } }, 1 };
+    block0->set_transactions({ chain::transaction{} });
+    block1->set_transactions({ chain::transaction{}, make_spend(spent) });
+    block1->header().set_previous_block_hash(block0->hash());
+    BOOST_REQUIRE(instance.push_front(block1));
+    BOOST_REQUIRE(instance.push_front(block0));
+
+    const chain::output_point outpoint{ spent };
+    instance.populate_spent(outpoint);
+    BOOST_REQUIRE(!outpoint.validation.spent);
+}
+
+// populate_prevout
+
+BOOST_AUTO_TEST_CASE(branch__populate_prevout__branch_tx__expected)
+{
+    branch instance;
+    DECLARE_BLOCK(block, 0);
+    DECLARE_BLOCK(block, 1);
+    const auto tx = make_spend({ hash_digest{ { 0x42 } }, 1 });
+    block0->set_transactions({ chain::transaction{}, tx });
+    block1->header().set_previous_block_hash(block0->hash());
+    BOOST_REQUIRE(instance.push_front(block1));
+    BOOST_REQUIRE(instance.push_front(block0));
+
+    const chain::output_point outpoint{ tx.hash(), 0 };
+    instance.populate_prevout(outpoint);
+    BOOST_REQUIRE(outpoint.validation.cache.is_valid());
+    BOOST_REQUIRE(!outpoint.validation.coinbase);
+    BOOST_REQUIRE_EQUAL(outpoint.validation.height, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(branch__populate_prevout__index_out_of_range__not_found)
+{
+    branch instance;
+    DECLARE_BLOCK(block, 0);
+    const auto tx = make_spend({ hash_digest{ { 0x42 } }, 1 });
+    block0->set_transactions({ chain::transaction{}, tx });
+    BOOST_REQUIRE(instance.push_front(block0));
+
+    const chain::output_point outpoint{ tx.hash(), 1 };
+    instance.populate_prevout(outpoint);
+    BOOST_REQUIRE(!outpoint.validation.cache.is_valid());
+}
+
+BOOST_AUTO_TEST_CASE(branch__populate_prevout__unknown_tx__not_found)
+{
+    branch instance;
+    DECLARE_BLOCK(block, 0);
+    block0->set_transactions({ chain::transaction{} });
+    BOOST_REQUIRE(instance.push_front(block0));
+
+    const chain::output_point outpoint{ hash_digest{ { 0x42 } }, 0 };
+    instance.populate_prevout(outpoint);
+    BOOST_REQUIRE(!outpoint.validation.cache.is_valid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,188 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(duplicate_filter_tests)
+
+static hash_digest random_hash()
+{
+    hash_digest hash;
+    pseudo_random_fill(hash);
+    return hash;
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__may_contain__not_armed__true)
+{
+    const duplicate_filter instance(100);
+    BOOST_REQUIRE(instance.enabled());
+    BOOST_REQUIRE(!instance.armed());
+    BOOST_REQUIRE(instance.may_contain(random_hash()));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__arm__zero_headroom__not_armed)
+{
+    duplicate_filter instance(0);
+    instance.allocate(100);
+    instance.arm();
+    BOOST_REQUIRE(!instance.enabled());
+    BOOST_REQUIRE(!instance.armed());
+    BOOST_REQUIRE(instance.may_contain(random_hash()));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__arm__not_allocated__not_armed)
+{
+    duplicate_filter instance(100);
+    instance.arm();
+    BOOST_REQUIRE(!instance.armed());
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__may_contain__armed_empty__false)
+{
+    duplicate_filter instance(100);
+    instance.allocate(0);
+    instance.arm();
+    BOOST_REQUIRE(instance.armed());
+    BOOST_REQUIRE(!instance.may_contain(random_hash()));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__insert__not_armed__not_counted)
+{
+    const auto hash = random_hash();
+    duplicate_filter instance(100);
+    instance.allocate(0);
+    instance.insert(hash);
+    instance.arm();
+    BOOST_REQUIRE(!instance.may_contain(hash));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__may_contain__loaded__true)
+{
+    duplicate_filter instance(100);
+    instance.allocate(1000);
+    const auto hash = random_hash();
+    instance.load(hash);
+    instance.arm();
+    BOOST_REQUIRE(instance.may_contain(hash));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__may_contain__inserted__true)
+{
+    duplicate_filter instance(1000);
+    instance.allocate(0);
+    instance.arm();
+
+    for (size_t count = 0; count < 1000; ++count)
+    {
+        const auto hash = random_hash();
+        instance.insert(hash);
+        BOOST_REQUIRE(instance.may_contain(hash));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__remove__inserted__false)
+{
+    const auto hash = random_hash();
+    duplicate_filter instance(100);
+    instance.allocate(0);
+    instance.arm();
+    instance.insert(hash);
+    instance.remove(hash);
+    BOOST_REQUIRE(!instance.may_contain(hash));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__remove__inserted_twice__true)
+{
+    const auto hash = random_hash();
+    duplicate_filter instance(100);
+    instance.allocate(0);
+    instance.arm();
+    instance.insert(hash);
+    instance.insert(hash);
+    instance.remove(hash);
+    BOOST_REQUIRE(instance.may_contain(hash));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__remove__saturated__true)
+{
+    const auto hash = random_hash();
+    duplicate_filter instance(100);
+    instance.allocate(0);
+    instance.arm();
+
+    for (size_t count = 0; count < 20; ++count)
+        instance.insert(hash);
+
+    for (size_t count = 0; count < 20; ++count)
+        instance.remove(hash);
+
+    BOOST_REQUIRE(instance.may_contain(hash));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__remove__others__inserted_true)
+{
+    static const size_t count = 1000;
+    duplicate_filter instance(count);
+    instance.allocate(count);
+    instance.arm();
+
+    hash_list kept;
+    hash_list removed;
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        kept.push_back(random_hash());
+        removed.push_back(random_hash());
+        instance.insert(kept.back());
+        instance.insert(removed.back());
+    }
+
+    for (const auto& hash: removed)
+        instance.remove(hash);
+
+    for (const auto& hash: kept)
+        BOOST_REQUIRE(instance.may_contain(hash));
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_filter__may_contain__at_capacity__few_false_positives)
+{
+    static const size_t capacity = 10000;
+    duplicate_filter instance(capacity);
+    instance.allocate(0);
+    instance.arm();
+
+    for (size_t count = 0; count < capacity; ++count)
+        instance.insert(random_hash());
+
+    size_t positives = 0;
+
+    for (size_t count = 0; count < capacity; ++count)
+        if (instance.may_contain(random_hash()))
+            ++positives;
+
+    // About one percent is expected, allow for blocking and chance.
+    BOOST_REQUIRE_LT(positives, capacity / 20);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(input_work_list_tests)
+
+static transaction make_transaction(size_t inputs)
+{
+    transaction tx;
+    tx.set_inputs(input::list(inputs));
+    return tx;
+}
+
+// A coinbase followed by txs with one, two and three inputs.
+static block make_block()
+{
+    block instance;
+    instance.set_transactions(
+    {
+        make_transaction(1),
+        make_transaction(1),
+        make_transaction(2),
+        make_transaction(3)
+    });
+
+    return instance;
+}
+
+BOOST_AUTO_TEST_CASE(input_work_list__construct__excludes_coinbase)
+{
+    const input_work_list instance(make_block(), false);
+    BOOST_REQUIRE_EQUAL(instance.size(), 6u);
+    BOOST_REQUIRE_EQUAL(instance.skipped(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(input_work_list__construct__skip_current__excludes_current)
+{
+    const auto instance = make_block();
+    instance.transactions()[2].validation.current = true;
+
+    const input_work_list work(instance, true);
+    BOOST_REQUIRE_EQUAL(work.size(), 4u);
+    BOOST_REQUIRE_EQUAL(work.skipped(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(input_work_list__claim__chunks__all_items_once_in_order)
+{
+    input_work_list instance(make_block(), false);
+    input_work_list::iterator begin;
+    input_work_list::iterator end;
+    size_t claimed = 0;
+
+    while (instance.claim(4, begin, end))
+    {
+        BOOST_REQUIRE(begin != end);
+        claimed += static_cast<size_t>(end - begin);
+    }
+
+    BOOST_REQUIRE_EQUAL(claimed, 6u);
+    BOOST_REQUIRE(!instance.claim(4, begin, end));
+}
+
+BOOST_AUTO_TEST_CASE(input_work_list__claim__first_item__first_input_of_second_tx)
+{
+    input_work_list instance(make_block(), false);
+    input_work_list::iterator begin;
+    input_work_list::iterator end;
+
+    BOOST_REQUIRE(instance.claim(1, begin, end));
+    BOOST_REQUIRE_EQUAL(begin->transaction, 1u);
+    BOOST_REQUIRE_EQUAL(begin->input, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(input_work_list__chunk_size__small_list__one)
+{
+    const input_work_list instance(make_block(), false);
+    BOOST_REQUIRE_EQUAL(instance.chunk_size(4), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(latency_histogram_tests)
+
+typedef latency_histogram::duration duration;
+
+BOOST_AUTO_TEST_CASE(latency_histogram__bucket__powers_of_two__expected)
+{
+    BOOST_REQUIRE_EQUAL(latency_histogram::bucket(duration(0)), 0u);
+    BOOST_REQUIRE_EQUAL(latency_histogram::bucket(duration(1)), 1u);
+    BOOST_REQUIRE_EQUAL(latency_histogram::bucket(duration(2)), 2u);
+    BOOST_REQUIRE_EQUAL(latency_histogram::bucket(duration(3)), 2u);
+    BOOST_REQUIRE_EQUAL(latency_histogram::bucket(duration(4)), 3u);
+    BOOST_REQUIRE_EQUAL(latency_histogram::bucket(duration(1000)), 10u);
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__bucket__overflow__last)
+{
+    const auto last = latency_histogram::bucket_count - 1u;
+    BOOST_REQUIRE_EQUAL(latency_histogram::bucket(duration::max()), last);
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__summarize__default__empty)
+{
+    const latency_histogram instance;
+    const auto summary = instance.summarize();
+    BOOST_REQUIRE_EQUAL(summary.count, 0u);
+    BOOST_REQUIRE(summary.total == duration::zero());
+    BOOST_REQUIRE(summary.maximum == duration::zero());
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__record__three__summarized)
+{
+    latency_histogram instance;
+    instance.record(duration(3));
+    instance.record(duration(2));
+    instance.record(duration(100));
+
+    const auto summary = instance.summarize();
+    BOOST_REQUIRE_EQUAL(summary.count, 3u);
+    BOOST_REQUIRE(summary.total == duration(105));
+    BOOST_REQUIRE(summary.maximum == duration(100));
+    BOOST_REQUIRE_EQUAL(summary.buckets[2], 2u);
+    BOOST_REQUIRE_EQUAL(summary.buckets[7], 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+#include "utility.hpp"
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::blockchain;
+using namespace bc::blockchain::test;
+
+BOOST_AUTO_TEST_SUITE(parked_blocks_tests)
+
+// A branch of three blocks above height 10, the top is at height 13.
+static branch::ptr make_branch()
+{
+    const auto block11 = make_block(1, null_hash);
+    const auto block12 = make_block(2, block11->hash());
+    const auto block13 = make_block(3, block12->hash());
+    const auto instance = std::make_shared<branch>(10);
+    BOOST_REQUIRE(instance->push_front(block13));
+    BOOST_REQUIRE(instance->push_front(block12));
+    BOOST_REQUIRE(instance->push_front(block11));
+    return instance;
+}
+
+static hash_digest hash_at(branch::const_ptr branch, size_t index)
+{
+    return (*branch->blocks())[index]->hash();
+}
+
+// park/unpark
+
+BOOST_AUTO_TEST_CASE(parked_blocks__park__new__parked)
+{
+    const auto path = make_branch();
+    parked_blocks instance(10);
+    instance.park(hash_at(path, 0), 11);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.is_parked(hash_at(path, 0)));
+    BOOST_REQUIRE(!instance.is_parked(hash_at(path, 1)));
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__unpark__parked__removed)
+{
+    const auto path = make_branch();
+    parked_blocks instance(10);
+    instance.park(hash_at(path, 0), 11);
+    instance.unpark(hash_at(path, 0));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(!instance.is_parked(hash_at(path, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__prune__below_depth__removed)
+{
+    const auto path = make_branch();
+    parked_blocks instance(10);
+    instance.park(hash_at(path, 0), 11);
+    instance.park(hash_at(path, 1), 12);
+    instance.prune(22);
+    BOOST_REQUIRE(!instance.is_parked(hash_at(path, 0)));
+    BOOST_REQUIRE(instance.is_parked(hash_at(path, 1)));
+}
+
+// get_error
+
+BOOST_AUTO_TEST_CASE(parked_blocks__get_error__parked_not_failed__success)
+{
+    const auto path = make_branch();
+    parked_blocks instance(10);
+    instance.park(hash_at(path, 0), 11);
+    BOOST_REQUIRE_EQUAL(instance.get_error(path), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__get_error__failed_ancestor__propagated)
+{
+    const auto path = make_branch();
+    parked_blocks instance(10);
+    instance.park(hash_at(path, 0), 11);
+    instance.fail(hash_at(path, 0), error::merkle_mismatch);
+    BOOST_REQUIRE_EQUAL(instance.get_error(path), error::merkle_mismatch);
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__get_error__failed_top__success)
+{
+    const auto path = make_branch();
+    parked_blocks instance(10);
+    instance.park(hash_at(path, 2), 13);
+    instance.fail(hash_at(path, 2), error::merkle_mismatch);
+    BOOST_REQUIRE_EQUAL(instance.get_error(path), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__fail__operational__not_retained)
+{
+    const auto path = make_branch();
+    parked_blocks instance(10);
+    instance.park(hash_at(path, 0), 11);
+    instance.fail(hash_at(path, 0), error::operation_failed_19);
+    instance.fail(hash_at(path, 0), error::service_stopped);
+    BOOST_REQUIRE(instance.is_parked(hash_at(path, 0)));
+    BOOST_REQUIRE_EQUAL(instance.get_error(path), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__fail__not_parked__not_retained)
+{
+    const auto path = make_branch();
+    parked_blocks instance(10);
+    instance.fail(hash_at(path, 0), error::merkle_mismatch);
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.get_error(path), error::success);
+}
+
+// is_retained
+
+BOOST_AUTO_TEST_CASE(parked_blocks__is_retained__consensus__true)
+{
+    BOOST_REQUIRE(parked_blocks::is_retained(error::merkle_mismatch));
+    BOOST_REQUIRE(parked_blocks::is_retained(error::invalid_script));
+    BOOST_REQUIRE(parked_blocks::is_retained(error::checkpoints_failed));
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__is_retained__operational__false)
+{
+    BOOST_REQUIRE(!parked_blocks::is_retained(error::success));
+    BOOST_REQUIRE(!parked_blocks::is_retained(error::service_stopped));
+    BOOST_REQUIRE(!parked_blocks::is_retained(error::operation_failed));
+    BOOST_REQUIRE(!parked_blocks::is_retained(error::operation_failed_18));
+    BOOST_REQUIRE(!parked_blocks::is_retained(error::operation_failed_19));
+}
+
+// get_prefix
+
+BOOST_AUTO_TEST_CASE(parked_blocks__get_prefix__first__one_block_same_fork)
+{
+    const auto path = make_branch();
+    const auto prefix = parked_blocks::get_prefix(path, 0);
+    BOOST_REQUIRE_EQUAL(prefix->size(), 1u);
+    BOOST_REQUIRE_EQUAL(prefix->height(), 10u);
+    BOOST_REQUIRE_EQUAL(prefix->top_height(), 11u);
+    BOOST_REQUIRE(prefix->top()->hash() == hash_at(path, 0));
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__get_prefix__middle__through_index)
+{
+    const auto path = make_branch();
+    const auto prefix = parked_blocks::get_prefix(path, 1);
+    BOOST_REQUIRE_EQUAL(prefix->size(), 2u);
+    BOOST_REQUIRE_EQUAL(prefix->top_height(), 12u);
+    BOOST_REQUIRE(prefix->top()->hash() == hash_at(path, 1));
+}
+
+BOOST_AUTO_TEST_CASE(parked_blocks__get_prefix__beyond_top__whole_branch)
+{
+    const auto path = make_branch();
+    const auto prefix = parked_blocks::get_prefix(path, 42);
+    BOOST_REQUIRE_EQUAL(prefix->size(), 3u);
+    BOOST_REQUIRE(prefix->top()->hash() == path->top()->hash());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(pooled_transactions_tests)
+
+static const hash_digest hash1{ { 0x01 } };
+static const hash_digest hash2{ { 0x02 } };
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__find__empty__false)
+{
+    const pooled_transactions instance(10);
+    uint32_t forks;
+    bool fresh;
+    BOOST_REQUIRE(!instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__find__added__expected_forks)
+{
+    pooled_transactions instance(10);
+    instance.add(hash1, 42);
+    uint32_t forks = 0;
+    bool fresh = false;
+    BOOST_REQUIRE(instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE_EQUAL(forks, 42u);
+    BOOST_REQUIRE(!instance.find(forks, fresh, hash2));
+}
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__add__existing__forks_updated)
+{
+    pooled_transactions instance(10);
+    instance.add(hash1, 42);
+    instance.add(hash1, 43);
+    uint32_t forks = 0;
+    bool fresh = false;
+    BOOST_REQUIRE(instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE_EQUAL(forks, 43u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__remove__added__not_found)
+{
+    pooled_transactions instance(10);
+    instance.add(hash1, 42);
+    instance.remove(hash1);
+    uint32_t forks;
+    bool fresh;
+    BOOST_REQUIRE(!instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__add__full_shard__oldest_evicted)
+{
+    // One entry per shard, both hashes select the same shard.
+    pooled_transactions instance(16);
+    const hash_digest hash17{ { 0x11 } };
+    instance.add(hash1, 42);
+    instance.add(hash17, 43);
+    uint32_t forks = 0;
+    bool fresh;
+    BOOST_REQUIRE(!instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE(instance.find(forks, fresh, hash17));
+    BOOST_REQUIRE_EQUAL(forks, 43u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__add__refreshed__other_evicted)
+{
+    // Two entries per shard, all hashes select the same shard.
+    pooled_transactions instance(32);
+    const hash_digest hash17{ { 0x11 } };
+    const hash_digest hash33{ { 0x21 } };
+    instance.add(hash1, 42);
+    instance.add(hash17, 42);
+    instance.add(hash1, 42);
+    instance.add(hash33, 42);
+    uint32_t forks;
+    bool fresh;
+    BOOST_REQUIRE(instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE(!instance.find(forks, fresh, hash17));
+    BOOST_REQUIRE(instance.find(forks, fresh, hash33));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__add__removed_then_full__removed_not_counted)
+{
+    pooled_transactions instance(32);
+    const hash_digest hash17{ { 0x11 } };
+    const hash_digest hash33{ { 0x21 } };
+    instance.add(hash1, 42);
+    instance.remove(hash1);
+    instance.add(hash17, 42);
+    instance.add(hash33, 42);
+    uint32_t forks;
+    bool fresh;
+    BOOST_REQUIRE(instance.find(forks, fresh, hash17));
+    BOOST_REQUIRE(instance.find(forks, fresh, hash33));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__find__invalidated__stale)
+{
+    pooled_transactions instance(10);
+    instance.add(hash1, 42);
+    uint32_t forks;
+    bool fresh = false;
+    BOOST_REQUIRE(instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE(fresh);
+
+    instance.invalidate();
+    BOOST_REQUIRE(instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE(!fresh);
+
+    instance.add(hash1, 42);
+    BOOST_REQUIRE(instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE(fresh);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_transactions__add__zero_capacity__disabled)
+{
+    pooled_transactions instance(0);
+    instance.add(hash1, 42);
+    uint32_t forks;
+    bool fresh;
+    BOOST_REQUIRE(!instance.find(forks, fresh, hash1));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(reject_filter_tests)
+
+static const auto hash1 = hash_literal(
+    "4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b");
+static const auto hash2 = hash_literal(
+    "0e3e2357e806b6cdb1f70b54c3a3a17b6714ee1f0e68bebb44a74b1efd512098");
+
+BOOST_AUTO_TEST_CASE(reject_filter__find__empty__success)
+{
+    const reject_filter instance(100);
+    BOOST_REQUIRE_EQUAL(instance.find(hash1), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(reject_filter__find__stored__reason)
+{
+    reject_filter instance(100);
+    instance.store(hash1, error::insufficient_fee);
+    BOOST_REQUIRE_EQUAL(instance.find(hash1), error::insufficient_fee);
+    BOOST_REQUIRE_EQUAL(instance.find(hash2), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(reject_filter__store__pool_dependent_reason__not_stored)
+{
+    reject_filter instance(100);
+    instance.store(hash1, error::missing_previous_output);
+    instance.store(hash2, error::service_stopped);
+    BOOST_REQUIRE_EQUAL(instance.find(hash1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.find(hash2), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(reject_filter__store__zero_capacity__disabled)
+{
+    reject_filter instance(0);
+    instance.store(hash1, error::dusty_transaction);
+    BOOST_REQUIRE_EQUAL(instance.find(hash1), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(reject_filter__store__single_slot__overwrites)
+{
+    reject_filter instance(1);
+    instance.store(hash1, error::dusty_transaction);
+    instance.store(hash2, error::invalid_script);
+    BOOST_REQUIRE_EQUAL(instance.find(hash1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.find(hash2), error::invalid_script);
+}
+
+BOOST_AUTO_TEST_CASE(reject_filter__clear__stored__success)
+{
+    reject_filter instance(100);
+    instance.store(hash1, error::stack_false);
+    instance.clear();
+    BOOST_REQUIRE_EQUAL(instance.find(hash1), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(reject_filter__is_cacheable__policy_and_script__true)
+{
+    BOOST_REQUIRE(reject_filter::is_cacheable(error::insufficient_fee));
+    BOOST_REQUIRE(reject_filter::is_cacheable(error::dusty_transaction));
+    BOOST_REQUIRE(reject_filter::is_cacheable(error::invalid_script));
+    BOOST_REQUIRE(!reject_filter::is_cacheable(error::success));
+    BOOST_REQUIRE(!reject_filter::is_cacheable(error::double_spend));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
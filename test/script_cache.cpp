@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::chain;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(script_cache_tests)
+
+static transaction make_transaction(uint32_t locktime)
+{
+    transaction tx;
+    tx.set_locktime(locktime);
+    return tx;
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__contains__empty__false)
+{
+    const script_cache instance(10);
+    BOOST_REQUIRE(!instance.contains(make_transaction(1), 0, 0));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__contains__stored__true)
+{
+    script_cache instance(10);
+    const auto tx = make_transaction(1);
+    instance.store(tx, 2, 42);
+    BOOST_REQUIRE(instance.contains(tx, 2, 42));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__contains__other_input_forks_or_tx__false)
+{
+    script_cache instance(10);
+    const auto tx = make_transaction(1);
+    instance.store(tx, 2, 42);
+    BOOST_REQUIRE(!instance.contains(tx, 3, 42));
+    BOOST_REQUIRE(!instance.contains(tx, 2, 43));
+    BOOST_REQUIRE(!instance.contains(make_transaction(2), 2, 42));
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__store__duplicate__not_counted)
+{
+    script_cache instance(10);
+    const auto tx = make_transaction(1);
+    instance.store(tx, 0, 0);
+    instance.store(tx, 0, 0);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__store__zero_capacity__disabled)
+{
+    script_cache instance(0);
+    const auto tx = make_transaction(1);
+    instance.store(tx, 0, 0);
+    BOOST_REQUIRE(!instance.contains(tx, 0, 0));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__store__beyond_capacity__bounded)
+{
+    // One entry per shard.
+    static const size_t capacity = 16;
+    script_cache instance(capacity);
+    const auto tx = make_transaction(1);
+
+    for (uint32_t index = 0; index < 1000; ++index)
+        instance.store(tx, index, 0);
+
+    BOOST_REQUIRE(instance.size() <= capacity);
+
+    // The most recent entry is never the one evicted.
+    BOOST_REQUIRE(instance.contains(tx, 999, 0));
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__clear__stored__empty)
+{
+    script_cache instance(10);
+    const auto tx = make_transaction(1);
+    instance.store(tx, 0, 0);
+    instance.clear();
+    BOOST_REQUIRE(!instance.contains(tx, 0, 0));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(transaction_organizer_tests)
+
+// A tx spending the given value, with an output script of the given size.
+static transaction_const_ptr make_transaction(uint64_t value_in,
+    uint64_t value_out, size_t padding)
+{
+    chain::input::list ins;
+    ins.emplace_back(chain::output_point{ null_hash, 0 }, chain::script{}, 0);
+
+    // Populate the prevout as would the organizer before admission.
+    ins.front().previous_output().validation.cache =
+        chain::output{ value_in, chain::script{} };
+
+    chain::output::list outs;
+    outs.emplace_back(value_out,
+        chain::script{ data_chunk(padding, 0x00), false });
+
+    return std::make_shared<const message::transaction>(
+        message::transaction{ 1, 0, std::move(ins), std::move(outs) });
+}
+
+BOOST_AUTO_TEST_CASE(transaction_organizer__admission_priority__higher_fee__higher)
+{
+    const auto low = make_transaction(1000, 900, 0);
+    const auto high = make_transaction(1000, 500, 0);
+    BOOST_REQUIRE_GT(transaction_organizer::admission_priority(high),
+        transaction_organizer::admission_priority(low));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_organizer__admission_priority__same_fee_fewer_bytes__higher)
+{
+    const auto small = make_transaction(1000, 500, 10);
+    const auto large = make_transaction(1000, 500, 1000);
+    BOOST_REQUIRE_GT(transaction_organizer::admission_priority(small),
+        transaction_organizer::admission_priority(large));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_organizer__admission_priority__no_fee__zero)
+{
+    const auto free = make_transaction(1000, 1000, 0);
+    BOOST_REQUIRE_EQUAL(transaction_organizer::admission_priority(free), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(undo_cache_tests)
+
+static const chain::output_point spent{ hash_digest{ { 0x42 } }, 1 };
+
+// A block spending the outpoint, with its prevout populated as by validation.
+static block_const_ptr make_block(uint32_t id, const chain::output_point& point,
+    size_t height)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ point }, chain::script{}, 0);
+    chain::output::list outputs(1);
+    const chain::transaction tx{ 1, 0, std::move(inputs), std::move(outputs) };
+
+    const auto block = std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, null_hash, null_hash, 0, 0, 0 },
+        { chain::transaction{}, tx }
+    });
+
+    auto& prevout = block->transactions()[1].inputs()[0].previous_output();
+    prevout.validation.cache = chain::output{ 42, chain::script{} };
+    prevout.validation.height = height;
+    prevout.validation.median_time_past = 7;
+    prevout.validation.coinbase = true;
+    return block;
+}
+
+static bool find(const undo_cache& instance, const chain::output_point& point,
+    size_t branch_height)
+{
+    chain::output output;
+    size_t height;
+    uint32_t median_time_past;
+    bool coinbase;
+    return instance.find(output, height, median_time_past, coinbase, point,
+        branch_height, false);
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__find__empty__false)
+{
+    const undo_cache instance(10);
+    BOOST_REQUIRE(!find(instance, spent, max_size_t));
+    BOOST_REQUIRE_EQUAL(instance.depth(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__find__connected__false)
+{
+    undo_cache instance(10);
+    instance.connect(*make_block(1, spent, 5));
+    BOOST_REQUIRE(!find(instance, spent, max_size_t));
+    BOOST_REQUIRE_EQUAL(instance.depth(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__find__disconnected__unspent_prevout)
+{
+    undo_cache instance(10);
+    const auto block = make_block(1, spent, 5);
+    instance.connect(*block);
+    instance.disconnect({ block }, 10);
+    BOOST_REQUIRE_EQUAL(instance.depth(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+
+    chain::output output;
+    size_t height;
+    uint32_t median_time_past;
+    bool coinbase;
+    BOOST_REQUIRE(instance.find(output, height, median_time_past, coinbase,
+        spent, 10, false));
+    BOOST_REQUIRE_EQUAL(output.value(), 42u);
+    BOOST_REQUIRE_EQUAL(height, 5u);
+    BOOST_REQUIRE_EQUAL(median_time_past, 7u);
+    BOOST_REQUIRE(coinbase);
+    BOOST_REQUIRE(output.validation.spender_height ==
+        chain::output::validation::not_spent);
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__find__require_confirmed__false)
+{
+    undo_cache instance(10);
+    const auto block = make_block(1, spent, 5);
+    instance.connect(*block);
+    instance.disconnect({ block }, 10);
+
+    chain::output output;
+    size_t height;
+    uint32_t median_time_past;
+    bool coinbase;
+    BOOST_REQUIRE(!instance.find(output, height, median_time_past, coinbase,
+        spent, 10, true));
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__find__above_branch_height__false)
+{
+    undo_cache instance(10);
+    const auto block = make_block(1, spent, 5);
+    instance.connect(*block);
+    instance.disconnect({ block }, 10);
+    BOOST_REQUIRE(!find(instance, spent, 4));
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__disconnect__created_above_fork__not_restored)
+{
+    undo_cache instance(10);
+    const auto block = make_block(1, spent, 5);
+    instance.connect(*block);
+    instance.disconnect({ block }, 4);
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(!find(instance, spent, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__connect__spends_restored__removed)
+{
+    undo_cache instance(10);
+    const auto block = make_block(1, spent, 5);
+    instance.connect(*block);
+    instance.disconnect({ block }, 10);
+    instance.connect(*make_block(2, spent, 5));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(!find(instance, spent, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__release__disconnected__removed)
+{
+    undo_cache instance(10);
+    const auto block = make_block(1, spent, 5);
+    instance.connect(*block);
+    instance.disconnect({ block }, 10);
+    instance.release({ block });
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(!find(instance, spent, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__release__other_blocks__retained)
+{
+    undo_cache instance(10);
+    const auto block = make_block(1, spent, 5);
+    const chain::output_point other{ hash_digest{ { 0x24 } }, 0 };
+    instance.connect(*block);
+    instance.disconnect({ block }, 10);
+    instance.release({ make_block(2, other, 5) });
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(find(instance, spent, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__connect__beyond_depth__oldest_not_restored)
+{
+    undo_cache instance(1);
+    const auto block1 = make_block(1, spent, 5);
+    const chain::output_point other{ hash_digest{ { 0x24 } }, 0 };
+    instance.connect(*block1);
+    instance.connect(*make_block(2, other, 5));
+    BOOST_REQUIRE_EQUAL(instance.depth(), 1u);
+
+    instance.disconnect({ block1 }, 10);
+    BOOST_REQUIRE(!find(instance, spent, max_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(undo_cache__connect__zero_depth__disabled)
+{
+    undo_cache instance(0);
+    const auto block = make_block(1, spent, 5);
+    instance.connect(*block);
+    instance.disconnect({ block }, 10);
+    BOOST_REQUIRE_EQUAL(instance.depth(), 0u);
+    BOOST_REQUIRE(!find(instance, spent, max_size_t));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,36 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_TEST_UTILITY_HPP
+#define LIBBITCOIN_BLOCKCHAIN_TEST_UTILITY_HPP
+
+#include <cstdint>
+#include <bitcoin/blockchain.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+namespace test {
+
+/// An empty block above the parent, made distinct by its nonce.
+block_const_ptr make_block(uint32_t nonce, const hash_digest& parent);
+
+} // namespace test
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
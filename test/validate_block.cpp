@@ -18,10 +18,12 @@
  */
 #include <boost/test/unit_test.hpp>
 #include <bitcoin/blockchain.hpp>
+#include "utility.hpp"
 
 using namespace bc;
 using namespace bc::chain;
 using namespace bc::blockchain;
+using namespace bc::blockchain::test;
 using namespace bc::machine;
 
 BOOST_AUTO_TEST_SUITE(validate_block_tests)
@@ -60,6 +62,39 @@ BOOST_AUTO_TEST_CASE(validate_block__native__block_438513_tx__valid) {
     BOOST_REQUIRE_EQUAL(result.value(), error::success);
 
 }
+
+BOOST_AUTO_TEST_CASE(validate_block__native__block_438513_tx_serialized__valid) {
+    static const auto index = 0u;
+    static const auto forks = 62u;
+    static const auto encoded_script = "a914faa558780a5767f9e3be14992a578fc1cbcf483087";
+    static const auto encoded_tx = "0100000001a06bf74cc36eac395188b06850c5a01d00b355065c589d14036e89e075d7518e000000009d483045022100ba555ac17a084e2a1b621c2171fa563bc4fb75cd5c0968153f44ba7203cb876f022036626f4579de16e3ad160df01f649ffb8dbf47b504ee56dc3ad7260af24ca0db0101004c50632102768e47607c52e581595711e27faffa7cb646b4f481fe269bd49691b2fbc12106ad6704355e2658b1756821028a5af8284a12848d69a25a0ac5cea20be905848eb645fd03d3b065df88a9117cacfeffffff0158920100000000001976a9149d86f66406d316d44d58cbf90d71179dd8162dd388ac355e2658";
+
+    data_chunk decoded_tx;
+    BOOST_REQUIRE(decode_base16(decoded_tx, encoded_tx));
+
+    data_chunk decoded_script;
+    BOOST_REQUIRE(decode_base16(decoded_script, encoded_script));
+
+    transaction tx;
+    BOOST_REQUIRE(tx.from_data(decoded_tx));
+
+    const auto& input = tx.inputs()[index];
+    auto& prevout = input.previous_output().validation.cache;
+
+    prevout.set_value(0);
+    prevout.set_script(script::factory_from_data(decoded_script, false));
+    BOOST_REQUIRE(prevout.script().is_valid());
+
+    // A buffer left over from a previous (longer) script must be overwritten.
+    data_chunk script_buffer(100, 0xff);
+    const auto tx_data = validate_input::serialize(tx);
+    const auto result = validate_input::verify_script(tx, index, forks,
+        tx_data, script_buffer);
+
+    BOOST_REQUIRE_EQUAL(result.value(), error::success);
+    BOOST_REQUIRE(script_buffer == decoded_script);
+}
+
 #ifdef BITPRIM_CURRENCY_BCH
 BOOST_AUTO_TEST_CASE(validate_block__native__block_520679_tx__valid)
 {
@@ -107,4 +142,108 @@ BOOST_AUTO_TEST_CASE(validate_block__native__block_520679_tx__valid)
 }
 #endif
 
+// is_assumed_valid
+
+// A branch of three blocks above height 10, the top is at height 13.
+static branch::ptr make_path(uint32_t nonce)
+{
+    const auto block11 = make_block(nonce, null_hash);
+    const auto block12 = make_block(nonce, block11->hash());
+    const auto block13 = make_block(nonce, block12->hash());
+    const auto path = std::make_shared<branch>(10);
+    BOOST_REQUIRE(path->push_front(block13));
+    BOOST_REQUIRE(path->push_front(block12));
+    BOOST_REQUIRE(path->push_front(block11));
+    return path;
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid__null_checkpoint__false)
+{
+    const auto path = make_path(1);
+    BOOST_REQUIRE(!validate_block::is_assumed_valid({}, 11, path, 10));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid__ancestor_in_path__true)
+{
+    const auto path = make_path(1);
+    hash_digest hash;
+    BOOST_REQUIRE(path->get_block_hash(hash, 12));
+    const config::checkpoint assume_valid{ hash, 12 };
+    BOOST_REQUIRE(validate_block::is_assumed_valid(assume_valid, 11, path, 10));
+    BOOST_REQUIRE(validate_block::is_assumed_valid(assume_valid, 12, path, 10));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid__above_height__false)
+{
+    const auto path = make_path(1);
+    hash_digest hash;
+    BOOST_REQUIRE(path->get_block_hash(hash, 12));
+    const config::checkpoint assume_valid{ hash, 12 };
+    BOOST_REQUIRE(!validate_block::is_assumed_valid(assume_valid, 13, path, 10));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid__other_block_at_height__false)
+{
+    hash_digest hash;
+    BOOST_REQUIRE(make_path(1)->get_block_hash(hash, 12));
+    const config::checkpoint assume_valid{ hash, 12 };
+
+    // A branch that reaches the height with another block does not contain it.
+    const auto other = make_path(2);
+    BOOST_REQUIRE(!validate_block::is_assumed_valid(assume_valid, 11, other, 10));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid__side_branch_below_height__false)
+{
+    // The store reaches the height, so contains the block, and a side branch
+    // that forks below it is not its ancestor.
+    const auto side = make_path(2);
+    const config::checkpoint assume_valid{ hash_digest{ { 0x42 } }, 20 };
+    BOOST_REQUIRE(!validate_block::is_assumed_valid(assume_valid, 11, side, 20));
+    BOOST_REQUIRE(!validate_block::is_assumed_valid(assume_valid, 13, side, 30));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid__path_below_height__true)
+{
+    // Each block of a sync extends the store by one, below the block.
+    const auto path = make_path(1);
+    const config::checkpoint assume_valid{ hash_digest{ { 0x42 } }, 20 };
+    BOOST_REQUIRE(validate_block::is_assumed_valid(assume_valid, 11, path, 10));
+    BOOST_REQUIRE(validate_block::is_assumed_valid(assume_valid, 13, path, 10));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid__path_below_height_reorganizing_below__true)
+{
+    // The store above the fork point is also below the block.
+    const auto path = make_path(1);
+    const config::checkpoint assume_valid{ hash_digest{ { 0x42 } }, 20 };
+    BOOST_REQUIRE(validate_block::is_assumed_valid(assume_valid, 11, path, 19));
+}
+
+// is_assumed_valid_conflict
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid_conflict__null_checkpoint__false)
+{
+    BOOST_REQUIRE(!validate_block::is_assumed_valid_conflict({}, 0, hash_digest{ { 0x42 } }));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid_conflict__other_hash_at_height__true)
+{
+    const config::checkpoint assume_valid{ hash_digest{ { 0x42 } }, 20 };
+    BOOST_REQUIRE(validate_block::is_assumed_valid_conflict(assume_valid, 20, hash_digest{ { 0x24 } }));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid_conflict__same_hash_at_height__false)
+{
+    const config::checkpoint assume_valid{ hash_digest{ { 0x42 } }, 20 };
+    BOOST_REQUIRE(!validate_block::is_assumed_valid_conflict(assume_valid, 20, hash_digest{ { 0x42 } }));
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__is_assumed_valid_conflict__other_height__false)
+{
+    const config::checkpoint assume_valid{ hash_digest{ { 0x42 } }, 20 };
+    BOOST_REQUIRE(!validate_block::is_assumed_valid_conflict(assume_valid, 19, hash_digest{ { 0x24 } }));
+    BOOST_REQUIRE(!validate_block::is_assumed_valid_conflict(assume_valid, 21, hash_digest{ { 0x24 } }));
+}
+
 BOOST_AUTO_TEST_SUITE_END()